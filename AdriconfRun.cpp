@@ -0,0 +1,130 @@
+/**
+ * adriconf-run: start a program with its drirc options exported as environment variables
+ * Usage: adriconf-run [--index FILE] [--binary-only] EXECUTABLE [ARGUMENTS...]
+ *
+ * Mesa reads an environment variable named after each option, so the program gets the same
+ * values the drirc would give it. The launcher only reads the index built by "adriconf index",
+ * it never parses XML nor queries the drivers, and it links nothing but the standard libraries.
+ * Variables already in the environment are kept, so they can still override the index.
+ *
+ * Unlike the drirc, the variables are inherited by every process the program starts, and they
+ * take precedence over the drirc entries of those processes too. With --binary-only nothing is
+ * exported when EXECUTABLE is a script, as the matched name is then only a wrapper around others.
+ */
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "LaunchIndex.h"
+
+#define USAGE "Usage: adriconf-run [--index FILE] [--binary-only] EXECUTABLE [ARGUMENTS...]\n" \
+              "The exported options are inherited by every process EXECUTABLE starts.\n"
+
+namespace {
+    bool readFile(const std::string &path, std::string &contents) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+            contents.reserve(static_cast<std::size_t>(fileStat.st_size));
+        }
+
+        char buffer[65536];
+        ssize_t readBytes;
+        while ((readBytes = read(fd, buffer, sizeof(buffer))) > 0) {
+            contents.append(buffer, static_cast<std::size_t>(readBytes));
+        }
+
+        close(fd);
+
+        return readBytes == 0;
+    }
+
+    /* Whether the file execvp would run starts with "#!", looking it up in PATH like execvp does */
+    bool isScript(const std::string &command) {
+        std::string path;
+        if (command.find('/') != std::string::npos) {
+            path = command;
+        } else {
+            const char *searchPath = std::getenv("PATH");
+            std::string directories(searchPath != nullptr ? searchPath : "/usr/local/bin:/usr/bin:/bin");
+            std::size_t start = 0;
+
+            while (start <= directories.size()) {
+                auto end = directories.find(':', start);
+                if (end == std::string::npos) {
+                    end = directories.size();
+                }
+
+                std::string directory(directories, start, end - start);
+                std::string candidate((directory.empty() ? "." : directory) + "/" + command);
+                if (access(candidate.c_str(), X_OK) == 0) {
+                    path = candidate;
+                    break;
+                }
+
+                start = end + 1;
+            }
+        }
+
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+
+        char magic[2];
+        bool script = read(fd, magic, sizeof(magic)) == sizeof(magic) && magic[0] == '#' && magic[1] == '!';
+        close(fd);
+
+        return script;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string indexPath(LaunchIndex::getDefaultPath());
+    bool binaryOnly = false;
+    int first = 1;
+
+    while (first < argc) {
+        if (std::strcmp(argv[first], "--index") == 0 && first + 1 < argc) {
+            indexPath = argv[first + 1];
+            first += 2;
+        } else if (std::strcmp(argv[first], "--binary-only") == 0) {
+            binaryOnly = true;
+            first++;
+        } else {
+            break;
+        }
+    }
+
+    if (first >= argc) {
+        std::fprintf(stderr, USAGE);
+        return 1;
+    }
+
+    std::string executable(argv[first]);
+    auto lastSlash = executable.find_last_of('/');
+    if (lastSlash != std::string::npos) {
+        executable = executable.substr(lastSlash + 1);
+    }
+
+    /* Without an index the program still starts, just without overrides */
+    std::string index;
+    if ((!binaryOnly || !isScript(argv[first])) && readFile(indexPath, index)) {
+        for (const auto &override : LaunchIndex::lookup(index, executable)) {
+            setenv(override.first.c_str(), override.second.c_str(), 0);
+        }
+    }
+
+    execvp(argv[first], argv + first);
+
+    std::fprintf(stderr, "adriconf-run: %s: %s\n", argv[first], std::strerror(errno));
+    return 127;
+}
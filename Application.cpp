@@ -1,5 +1,11 @@
 #include "Application.h"
 
+#include <functional>
+#include <initializer_list>
+#include <string>
+
+Application::Application() : engine(false), options() {}
+
 const Glib::ustring &Application::getName() const {
     return name;
 }
@@ -16,14 +22,117 @@ void Application::setExecutable(Glib::ustring executable) {
     this->executable = std::move(executable);
 }
 
+const Glib::ustring &Application::getExecutableRegexp() const {
+    return executableRegexp;
+}
+
+void Application::setExecutableRegexp(Glib::ustring executableRegexp) {
+    this->executableRegexp = std::move(executableRegexp);
+}
+
+const Glib::ustring &Application::getSha1() const {
+    return sha1;
+}
+
+void Application::setSha1(Glib::ustring sha1) {
+    this->sha1 = std::move(sha1);
+}
+
+const Glib::ustring &Application::getApplicationNameMatch() const {
+    return applicationNameMatch;
+}
+
+void Application::setApplicationNameMatch(Glib::ustring applicationNameMatch) {
+    this->applicationNameMatch = std::move(applicationNameMatch);
+}
+
+const Glib::ustring &Application::getApplicationVersions() const {
+    return applicationVersions;
+}
+
+void Application::setApplicationVersions(Glib::ustring applicationVersions) {
+    this->applicationVersions = std::move(applicationVersions);
+}
+
+const Glib::ustring &Application::getEngineNameMatch() const {
+    return engineNameMatch;
+}
+
+void Application::setEngineNameMatch(Glib::ustring engineNameMatch) {
+    this->engineNameMatch = std::move(engineNameMatch);
+}
+
+const Glib::ustring &Application::getEngineVersions() const {
+    return engineVersions;
+}
+
+void Application::setEngineVersions(Glib::ustring engineVersions) {
+    this->engineVersions = std::move(engineVersions);
+}
+
+bool Application::isEngine() const {
+    return engine;
+}
+
+void Application::setEngine(bool engine) {
+    this->engine = engine;
+}
+
+bool Application::isDefault() const {
+    return !this->engine
+           && this->executable.empty()
+           && this->executableRegexp.empty()
+           && this->sha1.empty()
+           && this->applicationNameMatch.empty()
+           && this->applicationVersions.empty();
+}
+
+bool Application::hasSameMatchRules(const Application &other) const {
+    return this->engine == other.engine
+           && this->executable == other.executable
+           && this->executableRegexp == other.executableRegexp
+           && this->sha1 == other.sha1
+           && this->applicationNameMatch == other.applicationNameMatch
+           && this->applicationVersions == other.applicationVersions
+           && this->engineNameMatch == other.engineNameMatch
+           && this->engineVersions == other.engineVersions;
+}
+
+std::size_t Application::getMatchRulesHash() const {
+    std::hash<std::string> hasher;
+    std::size_t hash = this->engine ? 1 : 0;
+
+    for (const auto *rule : {&this->executable, &this->executableRegexp, &this->sha1, &this->applicationNameMatch,
+                             &this->applicationVersions, &this->engineNameMatch, &this->engineVersions}) {
+        hash ^= hasher(rule->raw()) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+
+    return hash;
+}
+
+void Application::setMatchRules(const Application &other) {
+    this->engine = other.engine;
+    this->executable = other.executable;
+    this->executableRegexp = other.executableRegexp;
+    this->sha1 = other.sha1;
+    this->applicationNameMatch = other.applicationNameMatch;
+    this->applicationVersions = other.applicationVersions;
+    this->engineNameMatch = other.engineNameMatch;
+    this->engineVersions = other.engineVersions;
+}
+
 std::list<ApplicationOption_ptr> &Application::getOptions() {
     return this->options;
 }
 
+const std::list<ApplicationOption_ptr> &Application::getOptions() const {
+    return this->options;
+}
+
 void Application::addOption(ApplicationOption_ptr option) {
     this->options.emplace_back(option);
 }
 
 void Application::setOptions(std::list<ApplicationOption_ptr> options) {
     this->options = std::move(options);
-}
\ No newline at end of file
+}
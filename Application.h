@@ -10,9 +10,18 @@ class Application {
 private:
     Glib::ustring name;
     Glib::ustring executable;
+    Glib::ustring executableRegexp;
+    Glib::ustring sha1;
+    Glib::ustring applicationNameMatch;
+    Glib::ustring applicationVersions;
+    Glib::ustring engineNameMatch;
+    Glib::ustring engineVersions;
+    bool engine;
     std::list<ApplicationOption_ptr> options;
 
 public:
+    Application();
+
     const Glib::ustring &getName() const;
 
     void setName(Glib::ustring name);
@@ -21,8 +30,51 @@ public:
 
     void setExecutable(Glib::ustring executable);
 
+    const Glib::ustring &getExecutableRegexp() const;
+
+    void setExecutableRegexp(Glib::ustring executableRegexp);
+
+    const Glib::ustring &getSha1() const;
+
+    void setSha1(Glib::ustring sha1);
+
+    const Glib::ustring &getApplicationNameMatch() const;
+
+    void setApplicationNameMatch(Glib::ustring applicationNameMatch);
+
+    const Glib::ustring &getApplicationVersions() const;
+
+    void setApplicationVersions(Glib::ustring applicationVersions);
+
+    const Glib::ustring &getEngineNameMatch() const;
+
+    void setEngineNameMatch(Glib::ustring engineNameMatch);
+
+    const Glib::ustring &getEngineVersions() const;
+
+    void setEngineVersions(Glib::ustring engineVersions);
+
+    /* Engines are written as <engine> instead of <application> and match the engine name */
+    bool isEngine() const;
+
+    void setEngine(bool engine);
+
+    /* The default application has no matching rule at all, so it applies to every process */
+    bool isDefault() const;
+
+    /* Check if both applications have exactly the same matching rules */
+    bool hasSameMatchRules(const Application &other) const;
+
+    /* Hash of the matching rules, equal for applications that have the same matching rules */
+    std::size_t getMatchRulesHash() const;
+
+    /* Copy the matching rules (but not the name or options) from another application */
+    void setMatchRules(const Application &other);
+
     std::list<ApplicationOption_ptr> &getOptions();
 
+    const std::list<ApplicationOption_ptr> &getOptions() const;
+
     void addOption(ApplicationOption_ptr option);
 
     void setOptions(std::list<ApplicationOption_ptr>);
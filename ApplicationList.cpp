@@ -0,0 +1,179 @@
+#include "ApplicationList.h"
+
+#include <glibmm/i18n.h>
+
+ApplicationList::Columns::Columns() {
+    add(name);
+    add(driver);
+    add(screen);
+    add(application);
+}
+
+ApplicationList::ApplicationList(Gtk::TreeView *treeView, Gtk::SearchEntry *searchEntry)
+        : treeView(treeView), updating(false) {
+    this->store = Gtk::ListStore::create(this->columns);
+    this->filter = Gtk::TreeModelFilter::create(this->store);
+    this->filter->set_visible_func(sigc::mem_fun(this, &ApplicationList::isRowVisible));
+
+    /* Fixed sizes let the view skip measuring the rows that aren't visible */
+    this->treeView->set_model(this->filter);
+    this->treeView->append_column(_("Application"), this->columns.name);
+    this->treeView->append_column(_("Driver"), this->columns.driver);
+    for (auto column : this->treeView->get_columns()) {
+        column->set_sizing(Gtk::TREE_VIEW_COLUMN_FIXED);
+        column->set_resizable(true);
+    }
+    this->treeView->get_column(0)->set_fixed_width(220);
+    this->treeView->get_column(1)->set_fixed_width(80);
+    this->treeView->set_fixed_height_mode(true);
+    this->treeView->set_enable_search(false);
+
+    this->treeView->get_selection()->signal_changed().connect(
+            sigc::mem_fun(this, &ApplicationList::onSelectionChanged)
+    );
+
+    if (searchEntry != nullptr) {
+        searchEntry->signal_search_changed().connect(sigc::bind<Gtk::SearchEntry *>(
+                sigc::mem_fun(this, &ApplicationList::onFilterChanged), searchEntry
+        ));
+    }
+}
+
+bool ApplicationList::isRowVisible(const Gtk::TreeModel::const_iterator &row) const {
+    if (this->filterText.empty()) {
+        return true;
+    }
+
+    Glib::ustring name((*row)[this->columns.name]);
+    Glib::ustring driver((*row)[this->columns.driver]);
+
+    return name.casefold().find(this->filterText) != Glib::ustring::npos
+           || driver.casefold().find(this->filterText) != Glib::ustring::npos;
+}
+
+bool ApplicationList::rowMatches(const Gtk::TreeModel::Row &row, const Glib::ustring &driver, int screen,
+                                 const Application &application) const {
+    Glib::ustring rowDriver = row[this->columns.driver];
+    int rowScreen = row[this->columns.screen];
+    Application_ptr rowApplication = row[this->columns.application];
+
+    return rowDriver == driver && rowScreen == screen && rowApplication->hasSameMatchRules(application);
+}
+
+void ApplicationList::setRow(Gtk::TreeModel::Row row, const Device_ptr &device, const Application_ptr &application) {
+    row[this->columns.name] = application->getName();
+    row[this->columns.driver] = device->getDriver();
+    row[this->columns.screen] = device->getScreen();
+    row[this->columns.application] = application;
+}
+
+void ApplicationList::onFilterChanged(Gtk::SearchEntry *searchEntry) {
+    this->filterText = searchEntry->get_text().casefold();
+
+    this->updating = true;
+    this->filter->refilter();
+    this->updating = false;
+}
+
+void ApplicationList::onSelectionChanged() {
+    if (this->updating) {
+        return;
+    }
+
+    auto selected = this->treeView->get_selection()->get_selected();
+    if (!selected) {
+        return;
+    }
+
+    auto row = *selected;
+    Glib::ustring driver = row[this->columns.driver];
+    int screen = row[this->columns.screen];
+    Application_ptr application = row[this->columns.application];
+
+    this->selectedSignal.emit(driver, screen, application);
+}
+
+void ApplicationList::populate(const std::list<Device_ptr> &devices) {
+    this->updating = true;
+
+    /* Detach the model, so the view doesn't follow each row */
+    this->treeView->unset_model();
+    this->store->clear();
+
+    for (const auto &device : devices) {
+        for (const auto &application : device->getApplications()) {
+            this->setRow(*(this->store->append()), device, application);
+        }
+    }
+
+    this->treeView->set_model(this->filter);
+    this->updating = false;
+}
+
+void ApplicationList::addApplication(const Device_ptr &device, const Application_ptr &application) {
+    Gtk::TreeModel::iterator insertBefore = this->store->children().end();
+    bool deviceFound = false;
+
+    for (auto row = this->store->children().begin(); row != this->store->children().end(); ++row) {
+        Glib::ustring rowDriver = (*row)[this->columns.driver];
+        int rowScreen = (*row)[this->columns.screen];
+        Glib::ustring rowName = (*row)[this->columns.name];
+
+        if (rowDriver == device->getDriver() && rowScreen == device->getScreen()) {
+            deviceFound = true;
+
+            if (rowName > application->getName()) {
+                insertBefore = row;
+                break;
+            }
+        } else if (deviceFound) {
+            insertBefore = row;
+            break;
+        }
+    }
+
+    this->updating = true;
+    if (insertBefore == this->store->children().end()) {
+        this->setRow(*(this->store->append()), device, application);
+    } else {
+        this->setRow(*(this->store->insert(insertBefore)), device, application);
+    }
+    this->updating = false;
+}
+
+void ApplicationList::removeApplication(const Device_ptr &device, const Application &application) {
+    for (auto row = this->store->children().begin(); row != this->store->children().end(); ++row) {
+        if (this->rowMatches(*row, device->getDriver(), device->getScreen(), application)) {
+            this->updating = true;
+            this->store->erase(row);
+            this->updating = false;
+            return;
+        }
+    }
+}
+
+bool ApplicationList::select(const Device_ptr &device, const Application &application) {
+    for (auto row = this->store->children().begin(); row != this->store->children().end(); ++row) {
+        if (!this->rowMatches(*row, device->getDriver(), device->getScreen(), application)) {
+            continue;
+        }
+
+        auto filteredRow = this->filter->convert_child_iter_to_iter(row);
+        if (!filteredRow) {
+            return false;
+        }
+
+        this->updating = true;
+        this->treeView->get_selection()->select(filteredRow);
+        this->treeView->scroll_to_row(this->filter->get_path(filteredRow));
+        this->updating = false;
+
+        return true;
+    }
+
+    return false;
+}
+
+sigc::signal<void, const Glib::ustring &, int, const Application_ptr &> &ApplicationList::signalSelected() {
+    return this->selectedSignal;
+}
@@ -0,0 +1,67 @@
+#ifndef ADRICONF_APPLICATIONLIST_H
+#define ADRICONF_APPLICATIONLIST_H
+
+#include <list>
+#include <gtkmm.h>
+#include "Device.h"
+
+/**
+ * Model-backed list of the applications of every driver, with type-to-filter
+ * The tree view only realizes the visible rows, and adding or removing an application touches a single row.
+ * Rows identify an application by its match rules, so they stay valid when the application is copied on change.
+ */
+class ApplicationList {
+private:
+    class Columns : public Gtk::TreeModel::ColumnRecord {
+    public:
+        Gtk::TreeModelColumn<Glib::ustring> name;
+        Gtk::TreeModelColumn<Glib::ustring> driver;
+        Gtk::TreeModelColumn<int> screen;
+        Gtk::TreeModelColumn<Application_ptr> application;
+
+        Columns();
+    };
+
+    Columns columns;
+    Glib::RefPtr<Gtk::ListStore> store;
+    Glib::RefPtr<Gtk::TreeModelFilter> filter;
+    Gtk::TreeView *treeView;
+    Glib::ustring filterText;
+    /* Avoid reporting the selections done by code */
+    bool updating;
+    sigc::signal<void, const Glib::ustring &, int, const Application_ptr &> selectedSignal;
+
+    bool isRowVisible(const Gtk::TreeModel::const_iterator &row) const;
+
+    bool rowMatches(const Gtk::TreeModel::Row &row, const Glib::ustring &driver, int screen,
+                    const Application &application) const;
+
+    void setRow(Gtk::TreeModel::Row row, const Device_ptr &device, const Application_ptr &application);
+
+    void onFilterChanged(Gtk::SearchEntry *searchEntry);
+
+    void onSelectionChanged();
+
+public:
+    ApplicationList(Gtk::TreeView *treeView, Gtk::SearchEntry *searchEntry);
+
+    /* Replace every row, used only when the whole configuration changes */
+    void populate(const std::list<Device_ptr> &devices);
+
+    /* Add a single row, keeping the rows of the device sorted by name */
+    void addApplication(const Device_ptr &device, const Application_ptr &application);
+
+    /* Remove the row of the application from the device */
+    void removeApplication(const Device_ptr &device, const Application &application);
+
+    /**
+     * Select the row of the application, without emitting the selected signal
+     * @return false when the application isn't listed or is hidden by the filter
+     */
+    bool select(const Device_ptr &device, const Application &application);
+
+    /* Emitted when the user selects an application: driver, screen and the application as listed */
+    sigc::signal<void, const Glib::ustring &, int, const Application_ptr &> &signalSelected();
+};
+
+#endif
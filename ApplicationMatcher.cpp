@@ -0,0 +1,237 @@
+#include "ApplicationMatcher.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <glibmm/checksum.h>
+#include <glibmm/i18n.h>
+
+/* Length of the hexadecimal representation of a sha1 sum */
+#define SHA1_STRING_LENGTH 40
+
+ApplicationMatcher::Process::Process() : applicationVersion(0), engineVersion(0) {}
+
+void ApplicationMatcher::Process::setExecutable(const std::string &executableOrPath) {
+    auto lastSlash = executableOrPath.find_last_of('/');
+    if (lastSlash == std::string::npos) {
+        this->executable = executableOrPath;
+        this->executablePath.clear();
+    } else {
+        this->executable = executableOrPath.substr(lastSlash + 1);
+        this->executablePath = executableOrPath;
+    }
+}
+
+ApplicationMatcher::ApplicationMatcher(const Device_ptr &device) {
+    Glib::ustring combinedExpression;
+
+    for (const auto &application : device->getApplications()) {
+        Rule rule;
+        rule.application = application;
+        rule.engine = application->isEngine();
+        rule.selector = Selector::NONE;
+        std::size_t ordinal = this->rules.size();
+
+        if (rule.engine) {
+            if (!application->getEngineNameMatch().empty()) {
+                rule.expression = compileExpression(application->getEngineNameMatch());
+            }
+            rule.versions = parseVersionRange(application->getEngineVersions());
+
+            this->rules.emplace_back(rule);
+            this->unindexedRules.emplace_back(ordinal);
+            continue;
+        }
+
+        rule.versions = parseVersionRange(application->getApplicationVersions());
+
+        /* Same precedence as Mesa: only the first rule present after the executable is checked */
+        if (!application->getExecutableRegexp().empty()) {
+            rule.selector = Selector::EXECUTABLE_REGEXP;
+            rule.expression = compileExpression(application->getExecutableRegexp());
+
+            if (rule.expression != nullptr) {
+                if (!combinedExpression.empty()) {
+                    combinedExpression.append("|");
+                }
+                combinedExpression.append("(");
+                combinedExpression.append(application->getExecutableRegexp());
+                combinedExpression.append(")");
+            }
+        } else if (!application->getSha1().empty()) {
+            rule.selector = Selector::SHA1;
+
+            if (application->getSha1().bytes() != SHA1_STRING_LENGTH) {
+                std::cerr << Glib::ustring::compose(_("Incorrect sha1 on application '%1'. It will never match."),
+                                                    application->getName()) << std::endl;
+                continue;
+            }
+        } else if (!application->getApplicationNameMatch().empty()) {
+            rule.selector = Selector::APPLICATION_NAME;
+            rule.expression = compileExpression(application->getApplicationNameMatch());
+        }
+
+        this->rules.emplace_back(rule);
+
+        if (!application->getExecutable().empty()) {
+            this->executableIndex[application->getExecutable().raw()].emplace_back(ordinal);
+        } else if (rule.selector == Selector::SHA1) {
+            this->sha1Index[application->getSha1().raw()].emplace_back(ordinal);
+        } else {
+            this->unindexedRules.emplace_back(ordinal);
+        }
+    }
+
+    if (!combinedExpression.empty()) {
+        this->executableRegexpFilter = compileExpression(combinedExpression);
+    }
+}
+
+ApplicationMatcher::VersionRange ApplicationMatcher::parseVersionRange(const Glib::ustring &range) {
+    VersionRange versions;
+    versions.enabled = false;
+    versions.start = 0;
+    versions.end = 0;
+
+    if (range.empty()) {
+        return versions;
+    }
+
+    try {
+        std::size_t consumed = 0;
+        auto splitPos = range.raw().find(':');
+
+        if (splitPos == std::string::npos) {
+            versions.start = std::stoi(range.raw(), &consumed);
+            versions.end = versions.start;
+            if (consumed != range.raw().length()) {
+                throw std::invalid_argument(range.raw());
+            }
+        } else {
+            auto firstPart = range.raw().substr(0, splitPos);
+            auto secondPart = range.raw().substr(splitPos + 1);
+
+            versions.start = std::stoi(firstPart, &consumed);
+            if (consumed != firstPart.length()) {
+                throw std::invalid_argument(range.raw());
+            }
+
+            versions.end = std::stoi(secondPart, &consumed);
+            if (consumed != secondPart.length() || versions.start > versions.end) {
+                throw std::invalid_argument(range.raw());
+            }
+        }
+
+        versions.enabled = true;
+    } catch (const std::exception &ex) {
+        /* Mesa ignores invalid ranges */
+        std::cerr << Glib::ustring::compose(_("Failed to parse version range '%1'"), range) << std::endl;
+        versions.enabled = false;
+    }
+
+    return versions;
+}
+
+std::shared_ptr<std::regex> ApplicationMatcher::compileExpression(const Glib::ustring &expression) {
+    try {
+        return std::make_shared<std::regex>(
+                expression.raw(),
+                std::regex::extended | std::regex::nosubs | std::regex::optimize
+        );
+    } catch (const std::regex_error &ex) {
+        std::cerr << Glib::ustring::compose(_("Invalid regular expression '%1'"), expression) << std::endl;
+        return nullptr;
+    }
+}
+
+Glib::ustring ApplicationMatcher::computeSha1(const Glib::ustring &path) {
+    std::ifstream input(path.raw(), std::ios::binary);
+    if (!input.good()) {
+        return "";
+    }
+
+    std::ostringstream buffer;
+    buffer << input.rdbuf();
+
+    return Glib::Checksum::compute_checksum(Glib::Checksum::CHECKSUM_SHA1, buffer.str());
+}
+
+bool ApplicationMatcher::ruleMatches(
+        const Rule &rule,
+        const Process &process,
+        bool executableRegexpPossible,
+        const Glib::ustring &processSha1
+) const {
+    if (rule.engine) {
+        if (rule.expression != nullptr && !std::regex_search(process.engineName.raw(), *rule.expression)) {
+            return false;
+        }
+
+        return !rule.versions.enabled
+               || (process.engineVersion >= rule.versions.start && process.engineVersion <= rule.versions.end);
+    }
+
+    switch (rule.selector) {
+        case Selector::EXECUTABLE_REGEXP:
+            if (rule.expression != nullptr
+                && (!executableRegexpPossible || !std::regex_search(process.executable.raw(), *rule.expression))) {
+                return false;
+            }
+            break;
+
+        case Selector::SHA1:
+            if (processSha1.empty() || processSha1 != rule.application->getSha1()) {
+                return false;
+            }
+            break;
+
+        case Selector::APPLICATION_NAME:
+            if (rule.expression != nullptr && !std::regex_search(process.applicationName.raw(), *rule.expression)) {
+                return false;
+            }
+            break;
+
+        case Selector::NONE:
+            break;
+    }
+
+    return !rule.versions.enabled
+           || (process.applicationVersion >= rule.versions.start && process.applicationVersion <= rule.versions.end);
+}
+
+std::vector<Application_ptr> ApplicationMatcher::match(const Process &process) const {
+    std::vector<std::size_t> candidates(this->unindexedRules);
+
+    auto byExecutable = this->executableIndex.find(process.executable.raw());
+    if (byExecutable != this->executableIndex.end()) {
+        candidates.insert(candidates.end(), byExecutable->second.begin(), byExecutable->second.end());
+    }
+
+    Glib::ustring processSha1;
+    if (!this->sha1Index.empty() && !process.executablePath.empty()) {
+        processSha1 = computeSha1(process.executablePath);
+
+        auto bySha1 = this->sha1Index.find(processSha1.raw());
+        if (bySha1 != this->sha1Index.end()) {
+            candidates.insert(candidates.end(), bySha1->second.begin(), bySha1->second.end());
+        }
+    }
+
+    /* A single search tells if any of the executable expressions can match */
+    bool executableRegexpPossible = this->executableRegexpFilter == nullptr
+                                    || std::regex_search(process.executable.raw(), *this->executableRegexpFilter);
+
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<Application_ptr> matched;
+    for (auto ordinal : candidates) {
+        const auto &rule = this->rules[ordinal];
+
+        if (this->ruleMatches(rule, process, executableRegexpPossible, processSha1)) {
+            matched.emplace_back(rule.application);
+        }
+    }
+
+    return matched;
+}
@@ -0,0 +1,85 @@
+#ifndef ADRICONF_APPLICATIONMATCHER_H
+#define ADRICONF_APPLICATIONMATCHER_H
+
+#include <glibmm/ustring.h>
+#include <memory>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Device.h"
+
+/**
+ * Compiled form of every application and engine rule of a device
+ * Exact executables and sha1 sums are hashed, regular expressions are compiled only once
+ * and every executable_regexp rule is also merged into a single expression used to skip them all at once.
+ */
+class ApplicationMatcher {
+public:
+    /* The process we want to find the applications for */
+    struct Process {
+        Glib::ustring executable;
+        /* Only needed to match sha1 rules, the file is hashed only when the device has such rules */
+        Glib::ustring executablePath;
+        Glib::ustring applicationName;
+        int applicationVersion;
+        Glib::ustring engineName;
+        int engineVersion;
+
+        Process();
+
+        /* Set the executable from a name or a full path, a full path allows sha1 rules to be checked */
+        void setExecutable(const std::string &executableOrPath);
+    };
+
+private:
+    enum class Selector {
+        NONE,
+        EXECUTABLE_REGEXP,
+        SHA1,
+        APPLICATION_NAME
+    };
+
+    struct VersionRange {
+        bool enabled;
+        int start;
+        int end;
+    };
+
+    struct Rule {
+        Application_ptr application;
+        bool engine;
+        /* The first rule present after the executable, as Mesa only evaluates one of them */
+        Selector selector;
+        /* Mesa ignores an invalid expression, applying the rule anyway */
+        std::shared_ptr<std::regex> expression;
+        VersionRange versions;
+    };
+
+    std::vector<Rule> rules;
+    std::unordered_map<std::string, std::vector<std::size_t>> executableIndex;
+    std::unordered_map<std::string, std::vector<std::size_t>> sha1Index;
+    std::vector<std::size_t> unindexedRules;
+    std::shared_ptr<std::regex> executableRegexpFilter;
+
+    static VersionRange parseVersionRange(const Glib::ustring &range);
+
+    static std::shared_ptr<std::regex> compileExpression(const Glib::ustring &expression);
+
+    static Glib::ustring computeSha1(const Glib::ustring &path);
+
+    bool ruleMatches(const Rule &rule, const Process &process, bool executableRegexpPossible,
+                     const Glib::ustring &processSha1) const;
+
+public:
+    explicit ApplicationMatcher(const Device_ptr &device);
+
+    /**
+     * Find every application and engine that applies to the given process
+     * @param process
+     * @return The applications in document order, later ones override the options of the earlier ones
+     */
+    std::vector<Application_ptr> match(const Process &process) const;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "CommandLine.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <glibmm/i18n.h>
+#include <glibmm/ustring.h>
+
+namespace {
+    struct CommandEntry {
+        const char *name;
+        const char *synopsis;
+        /* Translated when printed */
+        const char *description;
+        CommandLine::Command run;
+    };
+
+    const CommandEntry COMMANDS[] = {
+            {
+                    "query",
+                    "adriconf query [--driver NAME] [--screen N] [--application-name NAME]"
+                    " [--application-version N] [--engine-name NAME] [--engine-version N] [EXECUTABLE...]",
+                    N_("  Executables are read from the standard input, one per line, when none is given."),
+                    CommandLine::runQuery
+            },
+            {
+                    "validate",
+                    "adriconf validate [FILE...]",
+                    N_("  Check the option values against the driver schema, the user drirc is used when no file is given."),
+                    CommandLine::runValidate
+            },
+            {
+                    "daemon",
+                    "adriconf daemon [--socket PATH]",
+                    N_("  Answer queries over a Unix socket, reloading the configuration when it changes."),
+                    CommandLine::runDaemon
+            },
+            {
+                    "index",
+                    "adriconf index [--driver NAME] [--screen N] [--output FILE]",
+                    N_("  Build the launch index used by adriconf-run, for the first matching driver."),
+                    CommandLine::runIndex
+            },
+            {
+                    "fleet",
+                    "adriconf fleet [--jobs N] [--system-wide FILE] [MANIFEST]",
+                    N_("  Write many drirc files in parallel, one per \"OVERLAY<TAB>OUTPUT\" manifest line (standard input by default)."),
+                    CommandLine::runFleet
+            },
+            {
+                    "to-json",
+                    "adriconf to-json [FILE]",
+                    N_("  Print a drirc file as JSON, the user drirc is used when no file is given."),
+                    CommandLine::runToJSON
+            },
+            {
+                    "from-json",
+                    "adriconf from-json [FILE]",
+                    N_("  Print a JSON configuration as a drirc file, reading the standard input when no file is given."),
+                    CommandLine::runFromJSON
+            },
+            {
+                    "memory",
+                    "adriconf memory",
+                    N_("  Print the memory used by the configuration model, per structure, and the process resident size."),
+                    CommandLine::runMemory
+            },
+            {
+                    "gpus",
+                    "adriconf gpus [--sysfs-root DIR]",
+                    N_("  List the GPUs found in sysfs, without waking them up."),
+                    CommandLine::runGPUs
+            }
+    };
+
+    const CommandEntry *findCommand(int argc, char *argv[]) {
+        if (argc < 2) {
+            return nullptr;
+        }
+
+        for (const auto &command : COMMANDS) {
+            if (std::strcmp(argv[1], command.name) == 0) {
+                return &command;
+            }
+        }
+
+        return nullptr;
+    }
+}
+
+void CommandLine::printUsage() {
+    std::cerr << _("Usage:") << std::endl
+              << "  adriconf [--autosave[=MILLISECONDS]]" << std::endl
+              << _("  Open the editor, optionally saving the changes once no edit happened for the given time.")
+              << std::endl
+              << _("  An autosave delay of 0 turns it off.") << std::endl;
+
+    for (const auto &command : COMMANDS) {
+        std::cerr << "  " << command.synopsis << std::endl
+                  << _(command.description) << std::endl;
+    }
+
+    std::cerr << _("Any of them accepts --stats, printing the internal counters on exit (also printed on SIGUSR1).")
+              << std::endl;
+}
+
+bool CommandLine::readInput(int argc, char *argv[], std::string &contents) {
+    if (argc > 3) {
+        printUsage();
+        return false;
+    }
+
+    std::ostringstream buffer;
+    if (argc == 3) {
+        std::ifstream input(argv[2]);
+        if (!input.good()) {
+            std::cerr << Glib::ustring::compose(_("Couldn't read file %1"), argv[2]) << std::endl;
+            return false;
+        }
+        buffer << input.rdbuf();
+    } else {
+        buffer << std::cin.rdbuf();
+    }
+
+    contents = buffer.str();
+    return true;
+}
+
+bool CommandLine::isHeadlessCommand(int argc, char *argv[]) {
+    return findCommand(argc, argv) != nullptr;
+}
+
+bool CommandLine::extractAutosaveDelay(int &argc, char *argv[], unsigned int &delay) {
+    bool valid = true;
+    int remaining = 1;
+    delay = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument(argv[i]);
+
+        if (argument == "--autosave") {
+            delay = AUTOSAVE_DEFAULT_DELAY;
+        } else if (argument.compare(0, 11, "--autosave=") == 0) {
+            /* Only plain digits, stoul would take "-1", "10s" or " 10" */
+            std::string value(argument.substr(11));
+            bool isNumber = !value.empty() && value.size() <= 9
+                            && value.find_first_not_of("0123456789") == std::string::npos;
+
+            if (isNumber) {
+                delay = static_cast<unsigned int>(std::stoul(value));
+            } else {
+                std::cerr << Glib::ustring::compose(_("Invalid value for %1"), argument) << std::endl;
+                valid = false;
+            }
+        } else {
+            argv[remaining++] = argv[i];
+        }
+    }
+
+    argc = remaining;
+
+    return valid;
+}
+
+bool CommandLine::extractStatsFlag(int &argc, char *argv[]) {
+    bool stats = false;
+    int remaining = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else {
+            argv[remaining++] = argv[i];
+        }
+    }
+
+    argc = remaining;
+
+    return stats;
+}
+
+int CommandLine::run(int argc, char *argv[]) {
+    auto command = findCommand(argc, argv);
+    if (command == nullptr) {
+        printUsage();
+        return 1;
+    }
+
+    return command->run(argc, argv);
+}
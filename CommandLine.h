@@ -0,0 +1,86 @@
+#ifndef ADRICONF_COMMANDLINE_H
+#define ADRICONF_COMMANDLINE_H
+
+#include <string>
+
+/* Idle time before an autosave, when --autosave is given without a value */
+#define AUTOSAVE_DEFAULT_DELAY 1000
+/* Driver option descriptions are not printed, so there is no need to look up the current language */
+#define HEADLESS_LOCALE "en"
+
+/**
+ * Headless commands, which run without opening any window
+ * Usage: adriconf <command> [options]
+ *
+ * The commands are listed in a table in CommandLine.cpp. Each one is implemented in a
+ * <Component>Command.cpp file next to the component it drives, and gets the whole command line
+ * (argv[1] being the command name).
+ */
+namespace CommandLine {
+    typedef int (*Command)(int argc, char *argv[]);
+
+    /* Check if the arguments ask for a headless command instead of the GUI */
+    bool isHeadlessCommand(int argc, char *argv[]);
+
+    /**
+     * Run the command given in the arguments
+     * @return The process exit code
+     */
+    int run(int argc, char *argv[]);
+
+    /**
+     * Remove the --autosave[=MILLISECONDS] option from the GUI arguments
+     * @param delay Set to the idle time before saving, or 0 when autosave wasn't asked (or given 0)
+     * @return False if the value isn't a number of milliseconds
+     */
+    bool extractAutosaveDelay(int &argc, char *argv[], unsigned int &delay);
+
+    /**
+     * Remove the --stats option, valid for the GUI and every command
+     * @return True if the counters must be printed on exit
+     */
+    bool extractStatsFlag(int &argc, char *argv[]);
+
+    /* Shared by the commands */
+
+    void printUsage();
+
+    /**
+     * Read a whole file, or the standard input when no path is given
+     * @param argc Accepts the command name and at most one path
+     * @param argv
+     * @param contents
+     * @return false after printing the error
+     */
+    bool readInput(int argc, char *argv[], std::string &contents);
+
+    /* The commands */
+
+    /* EffectiveConfigurationCommand.cpp */
+    int runQuery(int argc, char *argv[]);
+
+    /* ConfigurationValidatorCommand.cpp */
+    int runValidate(int argc, char *argv[]);
+
+    /* ConfigurationDaemonCommand.cpp */
+    int runDaemon(int argc, char *argv[]);
+
+    /* LaunchIndexBuilderCommand.cpp */
+    int runIndex(int argc, char *argv[]);
+
+    /* FleetRendererCommand.cpp */
+    int runFleet(int argc, char *argv[]);
+
+    /* JSONConfigurationCommand.cpp */
+    int runToJSON(int argc, char *argv[]);
+
+    int runFromJSON(int argc, char *argv[]);
+
+    /* MemoryReportCommand.cpp */
+    int runMemory(int argc, char *argv[]);
+
+    /* DRIQueryCommand.cpp */
+    int runGPUs(int argc, char *argv[]);
+};
+
+#endif
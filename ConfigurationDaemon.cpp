@@ -0,0 +1,525 @@
+#include "ConfigurationDaemon.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <glibmm/i18n.h>
+#include "ConfigurationLoader.h"
+#include "Counters.h"
+
+/* Driver option descriptions are never sent, so there is no need to look up the current language */
+#define DAEMON_LOCALE "en"
+/* A client sending a longer line without a line break is disconnected */
+#define DAEMON_MAX_LINE_LENGTH 65536
+/* Past this many unread answer bytes the requests of a client wait, and it isn't read anymore */
+#define DAEMON_MAX_OUTPUT_BYTES (1024 * 1024)
+
+namespace {
+    volatile sig_atomic_t stopRequested = 0;
+
+    void onStopSignal(int) {
+        stopRequested = 1;
+    }
+
+    std::vector<std::string> splitFields(const std::string &line) {
+        std::vector<std::string> fields;
+        std::size_t start = 0;
+
+        while (true) {
+            auto end = line.find('\t', start);
+            if (end == std::string::npos) {
+                fields.emplace_back(line.substr(start));
+                return fields;
+            }
+
+            fields.emplace_back(line.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    void appendError(std::string &output, const std::string &message) {
+        output.append("ERROR\t");
+        output.append(message);
+        output.append("\n");
+    }
+
+    void appendStat(std::string &output, const char *name, uint64_t value) {
+        output.append(name);
+        output.append("\t");
+        output.append(std::to_string(value));
+        output.append("\n");
+    }
+}
+
+ConfigurationDaemon::Client::Client() : closed(false) {}
+
+ConfigurationDaemon::ConfigurationDaemon(std::string socketPath)
+        : socketPath(std::move(socketPath)), listenFd(-1), inotifyFd(-1), queryCount(0), queryNanoseconds(0),
+          maxQueryNanoseconds(0), reloadCount(0), failedReloadCount(0), connectionCount(0) {}
+
+ConfigurationDaemon::~ConfigurationDaemon() {
+    for (const auto &client : this->clients) {
+        close(client.first);
+    }
+
+    if (this->inotifyFd >= 0) {
+        close(this->inotifyFd);
+    }
+
+    if (this->listenFd >= 0) {
+        close(this->listenFd);
+        unlink(this->socketPath.c_str());
+    }
+}
+
+std::string ConfigurationDaemon::getDefaultSocketPath() {
+    const char *runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir != nullptr && runtimeDir[0] != '\0') {
+        return std::string(runtimeDir) + "/adriconf.sock";
+    }
+
+    return "/tmp/adriconf-" + std::to_string(getuid()) + ".sock";
+}
+
+bool ConfigurationDaemon::listen() {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (this->socketPath.length() >= sizeof(address.sun_path)) {
+        std::cerr << Glib::ustring::compose(_("Socket path %1 is too long"), this->socketPath) << std::endl;
+        return false;
+    }
+    std::strncpy(address.sun_path, this->socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    this->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (this->listenFd < 0) {
+        std::cerr << Glib::ustring::compose(_("Couldn't create the socket: %1"), std::strerror(errno)) << std::endl;
+        return false;
+    }
+
+    /* A socket left by a daemon that didn't exit cleanly can be replaced, a running one can't */
+    int probeFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probeFd >= 0) {
+        bool alreadyRunning = connect(probeFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+        close(probeFd);
+
+        if (alreadyRunning) {
+            std::cerr << Glib::ustring::compose(_("Another daemon is already listening on %1"), this->socketPath)
+                      << std::endl;
+            close(this->listenFd);
+            this->listenFd = -1;
+            return false;
+        }
+    }
+    unlink(this->socketPath.c_str());
+
+    /* Only the user running the daemon may query it */
+    mode_t previousMask = umask(0077);
+    int bindResult = bind(this->listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    umask(previousMask);
+
+    if (bindResult < 0 || ::listen(this->listenFd, SOMAXCONN) < 0) {
+        std::cerr << Glib::ustring::compose(_("Couldn't listen on %1: %2"), this->socketPath, std::strerror(errno))
+                  << std::endl;
+        close(this->listenFd);
+        this->listenFd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void ConfigurationDaemon::watchConfigurationFiles() {
+    this->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->inotifyFd < 0) {
+        std::cerr << Glib::ustring::compose(_("Couldn't watch the configuration files: %1"), std::strerror(errno))
+                  << std::endl;
+        return;
+    }
+
+    /* Watch the directories, as editors usually replace the file instead of writing to it */
+    for (const auto &path : {ConfigurationLoader::getSystemWidePath(), ConfigurationLoader::getUserDefinedPath()}) {
+        auto directory = path.substr(0, path.find_last_of('/'));
+        if (directory.empty()) {
+            directory = "/";
+        }
+
+        if (inotify_add_watch(this->inotifyFd, directory.c_str(),
+                              IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0) {
+            std::cerr << Glib::ustring::compose(_("Couldn't watch %1: %2"), directory, std::strerror(errno))
+                      << std::endl;
+        }
+    }
+}
+
+bool ConfigurationDaemon::reload() {
+    try {
+        ConfigurationLoader configurationLoader;
+        Glib::ustring error;
+        auto loaded = configurationLoader.loadConcurrently(
+                DAEMON_LOCALE,
+                ConfigurationLoader::SYSTEM_WIDE | ConfigurationLoader::USER_DEFINED,
+                &error
+        );
+
+        /* Usually a file caught in the middle of being written, the next change reloads it */
+        if (!error.empty()) {
+            this->failedReloadCount++;
+            std::cerr << Glib::ustring::compose(_("Couldn't reload the configuration: %1"), error) << std::endl;
+            return false;
+        }
+
+        this->configuration.reset(new EffectiveConfiguration(
+                loaded.systemWideConfiguration,
+                this->driverConfiguration,
+                loaded.userDefinedConfiguration
+        ));
+    } catch (const std::exception &ex) {
+        this->failedReloadCount++;
+        std::cerr << Glib::ustring::compose(_("Couldn't reload the configuration: %1"), ex.what()) << std::endl;
+        return false;
+    }
+
+    this->reloadCount++;
+    return true;
+}
+
+bool ConfigurationDaemon::onConfigurationFileChanged() {
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+    auto systemWideName = ConfigurationLoader::getSystemWidePath();
+    auto userDefinedName = ConfigurationLoader::getUserDefinedPath();
+    systemWideName = systemWideName.substr(systemWideName.find_last_of('/') + 1);
+    userDefinedName = userDefinedName.substr(userDefinedName.find_last_of('/') + 1);
+
+    ssize_t length;
+    while ((length = read(this->inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for (char *position = buffer; position < buffer + length;) {
+            auto event = reinterpret_cast<inotify_event *>(position);
+
+            if (event->len > 0 && (systemWideName == event->name || userDefinedName == event->name)) {
+                changed = true;
+            }
+
+            position += sizeof(inotify_event) + event->len;
+        }
+    }
+
+    return changed;
+}
+
+void ConfigurationDaemon::acceptClients() {
+    while (true) {
+        int clientFd = accept4(this->listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientFd < 0) {
+            return;
+        }
+
+        this->connectionCount++;
+        this->clients[clientFd] = Client();
+    }
+}
+
+bool ConfigurationDaemon::readClient(int fd, Client &client) {
+    char buffer[4096];
+
+    /* Past the limits the client is left unread, so its socket buffer fills up and pushes back */
+    while (!client.closed && client.input.length() <= DAEMON_MAX_LINE_LENGTH
+           && client.output.length() < DAEMON_MAX_OUTPUT_BYTES) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+
+        /* The requests already received are still answered */
+        if (received == 0) {
+            client.closed = true;
+            break;
+        }
+
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+
+            break;
+        }
+
+        client.input.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    return true;
+}
+
+bool ConfigurationDaemon::answerClient(Client &client) {
+    std::size_t start = 0;
+    std::size_t end;
+    while (client.output.length() < DAEMON_MAX_OUTPUT_BYTES
+           && (end = client.input.find('\n', start)) != std::string::npos) {
+        auto line = client.input.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        this->handleLine(line, client.output);
+        start = end + 1;
+    }
+    client.input.erase(0, start);
+
+    /* The lines waiting for room in the output are complete, only a partial one can be too long */
+    return client.input.length() <= DAEMON_MAX_LINE_LENGTH || client.input.find('\n') != std::string::npos;
+}
+
+bool ConfigurationDaemon::writeClient(int fd, Client &client) {
+    std::size_t sent = 0;
+
+    while (sent < client.output.length()) {
+        ssize_t written = send(fd, client.output.data() + sent, client.output.length() - sent, MSG_NOSIGNAL);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false;
+            }
+
+            break;
+        }
+
+        sent += static_cast<std::size_t>(written);
+    }
+
+    client.output.erase(0, sent);
+
+    return true;
+}
+
+void ConfigurationDaemon::handleLine(const std::string &line, std::string &output) {
+    if (line.empty()) {
+        return;
+    }
+
+    auto fields = splitFields(line);
+
+    if (fields[0] == "QUERY") {
+        this->handleQuery(fields, output);
+    } else if (fields[0] == "STATS") {
+        this->handleStats(output);
+    } else if (fields[0] == "RELOAD") {
+        if (this->reload()) {
+            output.append("OK\n");
+        } else {
+            appendError(output, "reload failed");
+        }
+    } else {
+        appendError(output, "unknown command " + fields[0]);
+    }
+
+    output.append("\n");
+}
+
+void ConfigurationDaemon::handleQuery(const std::vector<std::string> &fields, std::string &output) {
+    if (fields.size() < 2 || fields[1].empty()) {
+        appendError(output, "missing executable");
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    EffectiveConfiguration::Query query;
+    query.process.setExecutable(fields[1]);
+    query.screen = -1;
+
+    try {
+        for (std::size_t i = 2; i < fields.size(); i++) {
+            auto split = fields[i].find('=');
+            auto key = fields[i].substr(0, split);
+            auto value = split == std::string::npos ? std::string() : fields[i].substr(split + 1);
+
+            if (key == "driver") {
+                query.driver = value;
+            } else if (key == "screen") {
+                query.screen = std::stoi(value);
+            } else if (key == "application-name") {
+                query.process.applicationName = value;
+            } else if (key == "application-version") {
+                query.process.applicationVersion = std::stoi(value);
+            } else if (key == "engine-name") {
+                query.process.engineName = value;
+            } else if (key == "engine-version") {
+                query.process.engineVersion = std::stoi(value);
+            } else {
+                appendError(output, "unknown field " + key);
+                return;
+            }
+        }
+    } catch (const std::exception &ex) {
+        appendError(output, "invalid value");
+        return;
+    }
+
+    /* Without a driver or screen filter we answer for every loaded driver, like the query command */
+    Glib::ustring driverFilter(query.driver);
+    int screenFilter = query.screen;
+
+    for (const auto &driverConf : this->driverConfiguration) {
+        if ((!driverFilter.empty() && driverConf.getDriver() != driverFilter)
+            || (screenFilter >= 0 && driverConf.getScreen() != screenFilter)) {
+            continue;
+        }
+
+        query.driver = driverConf.getDriver();
+        query.screen = driverConf.getScreen();
+
+        EffectiveConfiguration::appendValues(
+                output, query, this->configuration->query(query.process, query.driver, query.screen)
+        );
+    }
+
+    auto elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start
+    ).count());
+
+    this->queryCount++;
+    this->queryNanoseconds += elapsed;
+    if (elapsed > this->maxQueryNanoseconds) {
+        this->maxQueryNanoseconds = elapsed;
+    }
+}
+
+void ConfigurationDaemon::handleStats(std::string &output) {
+    auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - this->startTime
+    ).count();
+
+    appendStat(output, "uptime_seconds", static_cast<uint64_t>(uptime));
+    appendStat(output, "queries", this->queryCount);
+    appendStat(output, "average_query_ns", this->queryCount > 0 ? this->queryNanoseconds / this->queryCount : 0);
+    appendStat(output, "max_query_ns", this->maxQueryNanoseconds);
+    appendStat(output, "reloads", this->reloadCount);
+    appendStat(output, "failed_reloads", this->failedReloadCount);
+    appendStat(output, "connections", this->connectionCount);
+    appendStat(output, "clients", this->clients.size());
+    appendStat(output, "drivers", this->driverConfiguration.size());
+
+    /* The process-wide counters, covering every reload */
+    output.append(Counters::report());
+}
+
+int ConfigurationDaemon::run() {
+    this->startTime = std::chrono::steady_clock::now();
+
+    ConfigurationLoader configurationLoader;
+    this->driverConfiguration = configurationLoader.loadDriverSpecificConfiguration(DAEMON_LOCALE);
+
+    if (!this->reload() || !this->listen()) {
+        return 1;
+    }
+
+    this->watchConfigurationFiles();
+
+    struct sigaction stopAction;
+    std::memset(&stopAction, 0, sizeof(stopAction));
+    stopAction.sa_handler = onStopSignal;
+    /* No SA_RESTART, so poll() is interrupted */
+    sigaction(SIGINT, &stopAction, nullptr);
+    sigaction(SIGTERM, &stopAction, nullptr);
+
+    std::cerr << Glib::ustring::compose(_("Listening on %1"), this->socketPath) << std::endl;
+
+    std::vector<pollfd> pollFds;
+    while (!stopRequested) {
+        pollFds.clear();
+        pollFds.push_back({this->listenFd, POLLIN, 0});
+        if (this->inotifyFd >= 0) {
+            pollFds.push_back({this->inotifyFd, POLLIN, 0});
+        }
+        for (const auto &client : this->clients) {
+            short events = 0;
+            if (!client.second.closed && client.second.input.length() <= DAEMON_MAX_LINE_LENGTH
+                && client.second.output.length() < DAEMON_MAX_OUTPUT_BYTES) {
+                events |= POLLIN;
+            }
+            if (!client.second.output.empty()) {
+                events |= POLLOUT;
+            }
+            pollFds.push_back({client.first, events, 0});
+        }
+
+        if (poll(pollFds.data(), pollFds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            std::cerr << Glib::ustring::compose(_("poll failed: %1"), std::strerror(errno)) << std::endl;
+            return 1;
+        }
+
+        for (const auto &pollFd : pollFds) {
+            if (pollFd.revents == 0) {
+                continue;
+            }
+
+            if (pollFd.fd == this->listenFd) {
+                this->acceptClients();
+                continue;
+            }
+
+            if (pollFd.fd == this->inotifyFd) {
+                if (this->onConfigurationFileChanged()) {
+                    this->reload();
+                }
+                continue;
+            }
+
+            auto client = this->clients.find(pollFd.fd);
+            if (client == this->clients.end()) {
+                continue;
+            }
+
+            bool keep = !(pollFd.revents & (POLLERR | POLLNVAL));
+
+            if (keep && (pollFd.revents & (POLLIN | POLLHUP))) {
+                keep = this->readClient(client->first, client->second);
+            }
+
+            /*
+             * Answer right away, most of the time the whole answer fits in the socket buffer
+             * The lines left waiting for room in the output are answered as the client reads
+             */
+            while (keep) {
+                keep = this->answerClient(client->second);
+                if (!keep || client->second.output.empty()) {
+                    break;
+                }
+
+                keep = this->writeClient(client->first, client->second);
+                if (!client->second.output.empty()) {
+                    break;
+                }
+            }
+
+            /* A client that stopped sending still gets the end of its answers */
+            if (!keep || (client->second.closed && client->second.output.empty())) {
+                close(client->first);
+                this->clients.erase(client);
+            }
+        }
+    }
+
+    return 0;
+}
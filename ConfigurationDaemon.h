@@ -0,0 +1,98 @@
+#ifndef ADRICONF_CONFIGURATIONDAEMON_H
+#define ADRICONF_CONFIGURATIONDAEMON_H
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include "DriverConfiguration.h"
+#include "EffectiveConfiguration.h"
+
+/**
+ * Long-running server answering effective option queries over a Unix domain socket
+ * The drivers are queried once, the drirc files are reloaded when they change (inotify).
+ * Everything runs in a single poll() loop, so a query never waits for a lock.
+ *
+ * Line protocol, the fields are separated by tabs and every answer ends with an empty line:
+ *   QUERY <executable or path> [driver=NAME] [screen=N] [application-name=NAME] [application-version=N]
+ *         [engine-name=NAME] [engine-version=N]
+ *     Same lines as the query command, one per option of every matching driver
+ *   STATS
+ *     One "<name> <value>" line per counter
+ *   RELOAD
+ *     Read the drirc files again, answers OK
+ * Errors are answered with a single "ERROR <message>" line.
+ */
+class ConfigurationDaemon {
+private:
+    struct Client {
+        std::string input;
+        std::string output;
+        bool closed;
+
+        Client();
+    };
+
+    std::string socketPath;
+    int listenFd;
+    int inotifyFd;
+    std::list<DriverConfiguration> driverConfiguration;
+    std::unique_ptr<EffectiveConfiguration> configuration;
+    std::map<int, Client> clients;
+
+    /* Stats */
+    std::chrono::steady_clock::time_point startTime;
+    uint64_t queryCount;
+    uint64_t queryNanoseconds;
+    uint64_t maxQueryNanoseconds;
+    uint64_t reloadCount;
+    uint64_t failedReloadCount;
+    uint64_t connectionCount;
+
+    bool listen();
+
+    void watchConfigurationFiles();
+
+    /* Keep the current configuration when one of the files can't be parsed */
+    bool reload();
+
+    void acceptClients();
+
+    /* Returns false when the connection must be closed */
+    bool readClient(int fd, Client &client);
+
+    /* Handle the complete lines received, as long as the output has room. Returns false on a too long line */
+    bool answerClient(Client &client);
+
+    bool writeClient(int fd, Client &client);
+
+    void handleLine(const std::string &line, std::string &output);
+
+    void handleQuery(const std::vector<std::string> &fields, std::string &output);
+
+    void handleStats(std::string &output);
+
+    bool onConfigurationFileChanged();
+
+public:
+    explicit ConfigurationDaemon(std::string socketPath);
+
+    virtual ~ConfigurationDaemon();
+
+    /* $XDG_RUNTIME_DIR/adriconf.sock, or a per-user path in /tmp */
+    static std::string getDefaultSocketPath();
+
+    /**
+     * Load the configuration and serve until SIGINT or SIGTERM
+     * @return The process exit code
+     */
+    int run();
+
+    ConfigurationDaemon(const ConfigurationDaemon &) = delete;
+
+    ConfigurationDaemon &operator=(const ConfigurationDaemon &) = delete;
+};
+
+#endif
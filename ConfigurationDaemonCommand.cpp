@@ -0,0 +1,22 @@
+#include "CommandLine.h"
+
+#include <string>
+#include "ConfigurationDaemon.h"
+
+int CommandLine::runDaemon(int argc, char *argv[]) {
+    std::string socketPath(ConfigurationDaemon::getDefaultSocketPath());
+
+    for (int i = 2; i < argc; i++) {
+        std::string argument(argv[i]);
+
+        if (argument == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    ConfigurationDaemon daemon(socketPath);
+    return daemon.run();
+}
@@ -0,0 +1,191 @@
+#include "ConfigurationDiff.h"
+
+#include <algorithm>
+#include <map>
+#include <glibmm/i18n.h>
+
+namespace {
+    Glib::ustring applicationKey(const Application_ptr &application) {
+        /* Identify the application by its most specific matching rule */
+        if (!application->getExecutable().empty()) {
+            return application->getExecutable();
+        }
+
+        if (!application->getExecutableRegexp().empty()) {
+            return application->getExecutableRegexp();
+        }
+
+        if (!application->getSha1().empty()) {
+            return application->getSha1();
+        }
+
+        if (!application->getApplicationNameMatch().empty()) {
+            return application->getApplicationNameMatch();
+        }
+
+        if (!application->getEngineNameMatch().empty()) {
+            return application->getEngineNameMatch();
+        }
+
+        /* The default application has no rule at all, so we identify it by its name */
+        return application->getName();
+    }
+
+    /* Name-value map of the options, the last repeated option wins as in the driver */
+    std::map<Glib::ustring, Glib::ustring> optionsToMap(const Application_ptr &application) {
+        std::map<Glib::ustring, Glib::ustring> options;
+
+        for (const auto &option : application->getOptions()) {
+            options[option->getName()] = option->getValue();
+        }
+
+        return options;
+    }
+
+    ConfigurationDiff::Change makeChange(
+            ConfigurationDiff::ChangeType type,
+            const Device_ptr &device,
+            const Glib::ustring &application
+    ) {
+        ConfigurationDiff::Change change;
+        change.type = type;
+        change.driver = device->getDriver();
+        change.screen = device->getScreen();
+        change.application = application;
+
+        return change;
+    }
+}
+
+void ConfigurationDiff::canonicalize(std::list<Device_ptr> &devices) {
+    for (const auto &device : devices) {
+        for (auto &application : device->getApplications()) {
+            /* Ordered by name, the last repeated option overwrites the previous ones */
+            std::map<Glib::ustring, ApplicationOption_ptr> sortedOptions;
+            for (const auto &option : application->getOptions()) {
+                sortedOptions[option->getName()] = option;
+            }
+
+            std::list<ApplicationOption_ptr> options;
+            for (const auto &option : sortedOptions) {
+                options.emplace_back(option.second);
+            }
+
+            application->setOptions(options);
+        }
+    }
+}
+
+std::list<ConfigurationDiff::Change> ConfigurationDiff::compare(
+        const std::list<Device_ptr> &before,
+        const std::list<Device_ptr> &after
+) {
+    std::list<Change> changes;
+
+    for (const auto &afterDevice : after) {
+        auto beforeDevice = std::find_if(before.begin(), before.end(), [&afterDevice](const Device_ptr &d) {
+            return d->getDriver() == afterDevice->getDriver() && d->getScreen() == afterDevice->getScreen();
+        });
+
+        if (beforeDevice == before.end()) {
+            changes.emplace_back(makeChange(ChangeType::ADDED, afterDevice, ""));
+            continue;
+        }
+
+        std::map<Glib::ustring, Application_ptr> beforeApps;
+        for (const auto &app : (*beforeDevice)->getApplications()) {
+            beforeApps[applicationKey(app)] = app;
+        }
+
+        for (const auto &afterApp : afterDevice->getApplications()) {
+            auto beforeApp = beforeApps.find(applicationKey(afterApp));
+            if (beforeApp == beforeApps.end()) {
+                changes.emplace_back(makeChange(ChangeType::ADDED, afterDevice, applicationKey(afterApp)));
+                continue;
+            }
+
+            auto beforeOptions = optionsToMap(beforeApp->second);
+            auto afterOptions = optionsToMap(afterApp);
+            beforeApps.erase(beforeApp);
+
+            for (const auto &afterOption : afterOptions) {
+                auto beforeOption = beforeOptions.find(afterOption.first);
+
+                if (beforeOption == beforeOptions.end()) {
+                    auto change = makeChange(ChangeType::ADDED, afterDevice, applicationKey(afterApp));
+                    change.option = afterOption.first;
+                    change.newValue = afterOption.second;
+                    changes.emplace_back(change);
+                    continue;
+                }
+
+                if (beforeOption->second != afterOption.second) {
+                    auto change = makeChange(ChangeType::CHANGED, afterDevice, applicationKey(afterApp));
+                    change.option = afterOption.first;
+                    change.oldValue = beforeOption->second;
+                    change.newValue = afterOption.second;
+                    changes.emplace_back(change);
+                }
+
+                beforeOptions.erase(beforeOption);
+            }
+
+            for (const auto &removedOption : beforeOptions) {
+                auto change = makeChange(ChangeType::REMOVED, afterDevice, applicationKey(afterApp));
+                change.option = removedOption.first;
+                change.oldValue = removedOption.second;
+                changes.emplace_back(change);
+            }
+        }
+
+        for (const auto &removedApp : beforeApps) {
+            changes.emplace_back(makeChange(ChangeType::REMOVED, *beforeDevice, removedApp.first));
+        }
+    }
+
+    for (const auto &beforeDevice : before) {
+        auto afterDevice = std::find_if(after.begin(), after.end(), [&beforeDevice](const Device_ptr &d) {
+            return d->getDriver() == beforeDevice->getDriver() && d->getScreen() == beforeDevice->getScreen();
+        });
+
+        if (afterDevice == after.end()) {
+            changes.emplace_back(makeChange(ChangeType::REMOVED, beforeDevice, ""));
+        }
+    }
+
+    return changes;
+}
+
+Glib::ustring ConfigurationDiff::describe(const ConfigurationDiff::Change &change) {
+    if (change.application.empty()) {
+        if (change.type == ChangeType::ADDED) {
+            return Glib::ustring::compose(_("Added driver '%1' on screen '%2'"), change.driver, change.screen);
+        }
+
+        return Glib::ustring::compose(_("Removed driver '%1' on screen '%2'"), change.driver, change.screen);
+    }
+
+    if (change.option.empty()) {
+        if (change.type == ChangeType::ADDED) {
+            return Glib::ustring::compose(_("Added application '%1' to driver '%2'"), change.application,
+                                          change.driver);
+        }
+
+        return Glib::ustring::compose(_("Removed application '%1' from driver '%2'"), change.application,
+                                      change.driver);
+    }
+
+    switch (change.type) {
+        case ChangeType::ADDED:
+            return Glib::ustring::compose(_("Application '%1' on driver '%2': option '%3' set to '%4'"),
+                                          change.application, change.driver, change.option, change.newValue);
+        case ChangeType::REMOVED:
+            return Glib::ustring::compose(_("Application '%1' on driver '%2': option '%3' (was '%4') removed"),
+                                          change.application, change.driver, change.option, change.oldValue);
+        case ChangeType::CHANGED:
+        default:
+            return Glib::ustring::compose(_("Application '%1' on driver '%2': option '%3' changed from '%4' to '%5'"),
+                                          change.application, change.driver, change.option, change.oldValue,
+                                          change.newValue);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef ADRICONF_CONFIGURATIONDIFF_H
+#define ADRICONF_CONFIGURATIONDIFF_H
+
+#include <list>
+#include <string>
+#include <cstdint>
+#include <glibmm/ustring.h>
+#include "Device.h"
+
+namespace ConfigurationDiff {
+    enum class ChangeType {
+        ADDED,
+        REMOVED,
+        CHANGED
+    };
+
+    /**
+     * A single difference between two configurations
+     * Application-level changes have an empty option name
+     */
+    struct Change {
+        ChangeType type;
+        Glib::ustring driver;
+        int screen;
+        Glib::ustring application;
+        Glib::ustring option;
+        Glib::ustring oldValue;
+        Glib::ustring newValue;
+    };
+
+    /**
+     * Put the options of every application in a stable order, so the same configuration always generates the same XML
+     * Options are ordered by name, repeated ones being reduced to the last one, which is the one the driver uses.
+     * Devices and applications keep their order: Mesa applies every matching one in document order, the later
+     * ones taking precedence, so moving them would change which value wins. The resolver already produces
+     * them in a deterministic order.
+     * @param devices
+     */
+    void canonicalize(std::list<Device_ptr> &devices);
+
+    /**
+     * List every application and option added, removed or changed from one configuration to the other
+     * @param before
+     * @param after
+     * @return The list of changes, in the order of the "after" configuration
+     */
+    std::list<Change> compare(const std::list<Device_ptr> &before, const std::list<Device_ptr> &after);
+
+    /**
+     * Generate a human readable line describing the change, suitable for logging
+     * @param change
+     */
+    Glib::ustring describe(const Change &change);
+};
+
+#endif
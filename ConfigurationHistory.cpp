@@ -0,0 +1,158 @@
+#include "ConfigurationHistory.h"
+
+#include <algorithm>
+#include "Counters.h"
+
+namespace {
+    /* Replace the device by its copy in a new device list, which shares every other device */
+    std::list<Device_ptr> replaceDevice(
+            const std::list<Device_ptr> &devices,
+            const Device_ptr &oldDevice,
+            const Device_ptr &newDevice
+    ) {
+        std::list<Device_ptr> newDevices(devices);
+        std::replace(newDevices.begin(), newDevices.end(), oldDevice, newDevice);
+
+        return newDevices;
+    }
+}
+
+ConfigurationHistory::ConfigurationHistory() : snapshots(1), current(0) {}
+
+void ConfigurationHistory::reset(const std::list<Device_ptr> &configuration) {
+    this->snapshots.clear();
+    this->snapshots.emplace_back(configuration);
+    this->current = 0;
+    this->lastMergeKey.clear();
+}
+
+const std::list<Device_ptr> &ConfigurationHistory::getCurrent() const {
+    return this->snapshots[this->current];
+}
+
+const std::vector<std::list<Device_ptr>> &ConfigurationHistory::getSnapshots() const {
+    return this->snapshots;
+}
+
+void ConfigurationHistory::commit(const std::list<Device_ptr> &snapshot, const Glib::ustring &mergeKey) {
+    bool canMerge = !mergeKey.empty()
+                    && mergeKey == this->lastMergeKey
+                    && this->current > 0
+                    && this->current + 1 == this->snapshots.size();
+
+    this->snapshots.resize(this->current + 1);
+
+    if (canMerge) {
+        this->snapshots[this->current] = snapshot;
+        return;
+    }
+
+    this->snapshots.emplace_back(snapshot);
+    this->current++;
+    this->lastMergeKey = mergeKey;
+
+    if (this->snapshots.size() > CONFIGURATION_HISTORY_SIZE + 1) {
+        this->snapshots.erase(this->snapshots.begin());
+        this->current--;
+    }
+}
+
+void ConfigurationHistory::addDevice(const Device_ptr &device) {
+    for (auto &snapshot : this->snapshots) {
+        snapshot.emplace_back(device);
+    }
+}
+
+bool ConfigurationHistory::canUndo() const {
+    return this->current > 0;
+}
+
+bool ConfigurationHistory::canRedo() const {
+    return this->current + 1 < this->snapshots.size();
+}
+
+const std::list<Device_ptr> &ConfigurationHistory::undo() {
+    if (this->canUndo()) {
+        this->current--;
+    }
+
+    /* Changes after an undo always start a new step */
+    this->lastMergeKey.clear();
+
+    return this->getCurrent();
+}
+
+const std::list<Device_ptr> &ConfigurationHistory::redo() {
+    if (this->canRedo()) {
+        this->current++;
+    }
+
+    this->lastMergeKey.clear();
+
+    return this->getCurrent();
+}
+
+Application_ptr ConfigurationHistory::withOptionValue(
+        const Application_ptr &application,
+        const Glib::ustring &optionName,
+        const Glib::ustring &value
+) {
+    auto newApplication = std::make_shared<Application>(*application);
+    std::list<ApplicationOption_ptr> options;
+    bool optionFound = false;
+
+    for (const auto &option : application->getOptions()) {
+        if (option->getName() != optionName) {
+            options.emplace_back(option);
+            continue;
+        }
+
+        if (!optionFound) {
+            auto newOption = std::make_shared<ApplicationOption>();
+            newOption->setName(optionName);
+            newOption->setValue(value);
+            options.emplace_back(newOption);
+            optionFound = true;
+        }
+    }
+
+    if (!optionFound) {
+        auto newOption = std::make_shared<ApplicationOption>();
+        newOption->setName(optionName);
+        newOption->setValue(value);
+        options.emplace_back(newOption);
+    }
+
+    newApplication->setOptions(options);
+    Counters::add(Counters::Counter::OPTIONS_ALLOCATED);
+
+    return newApplication;
+}
+
+std::list<Device_ptr> ConfigurationHistory::withApplicationReplaced(
+        const std::list<Device_ptr> &devices,
+        const Device_ptr &device,
+        const Application_ptr &oldApplication,
+        const Application_ptr &newApplication
+) {
+    auto newDevice = std::make_shared<Device>(*device);
+
+    if (newApplication == nullptr) {
+        newDevice->removeApplication(oldApplication);
+    } else {
+        newDevice->replaceApplication(oldApplication, newApplication);
+    }
+
+    return replaceDevice(devices, device, newDevice);
+}
+
+std::list<Device_ptr> ConfigurationHistory::withApplicationAdded(
+        const std::list<Device_ptr> &devices,
+        const Device_ptr &device,
+        const Application_ptr &application
+) {
+    auto newDevice = std::make_shared<Device>(*device);
+    newDevice->insertApplication(application);
+
+    return replaceDevice(devices, device, newDevice);
+}
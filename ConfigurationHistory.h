@@ -0,0 +1,86 @@
+#ifndef ADRICONF_CONFIGURATIONHISTORY_H
+#define ADRICONF_CONFIGURATIONHISTORY_H
+
+#include <list>
+#include <vector>
+#include <glibmm/ustring.h>
+#include "Device.h"
+
+/* How many changes can be undone */
+#define CONFIGURATION_HISTORY_SIZE 200
+
+/**
+ * Undo/redo history of the user-defined configuration
+ * Devices, applications and options are never changed once they are part of a snapshot (copy-on-write).
+ * A change copies the device list, the changed device and the changed application. That copies their
+ * pointer lists (and the device's application index), so an edit costs O(devices + applications of the
+ * device + options of the application). The applications and options themselves are shared with the
+ * previous snapshot, and restoring a snapshot is O(1).
+ */
+class ConfigurationHistory {
+private:
+    std::vector<std::list<Device_ptr>> snapshots;
+    std::size_t current;
+    /* Consecutive changes with the same key are merged, like a spin button being dragged */
+    Glib::ustring lastMergeKey;
+
+public:
+    ConfigurationHistory();
+
+    /* Drop every snapshot and start from the given configuration */
+    void reset(const std::list<Device_ptr> &configuration);
+
+    const std::list<Device_ptr> &getCurrent() const;
+
+    /* Every snapshot kept for undo and redo, including the current one */
+    const std::vector<std::list<Device_ptr>> &getSnapshots() const;
+
+    /**
+     * Add a new snapshot, discarding anything that could be redone
+     * @param snapshot The new configuration, built with the helpers below
+     * @param mergeKey When equal to the key of the last commit, the last snapshot is replaced instead
+     */
+    void commit(const std::list<Device_ptr> &snapshot, const Glib::ustring &mergeKey);
+
+    /**
+     * Add a device to every snapshot, for devices that appear without a user change (a GPU plugged in)
+     * Undo and redo keep the device, and the undo steps are kept.
+     */
+    void addDevice(const Device_ptr &device);
+
+    bool canUndo() const;
+
+    bool canRedo() const;
+
+    const std::list<Device_ptr> &undo();
+
+    const std::list<Device_ptr> &redo();
+
+    /* Copy of the application with the option set to the given value, the other options are shared */
+    static Application_ptr withOptionValue(
+            const Application_ptr &application,
+            const Glib::ustring &optionName,
+            const Glib::ustring &value
+    );
+
+    /**
+     * Copy of the device list where the device has one application replaced
+     * The device is copied with its application list and index, the other applications are shared.
+     * @param newApplication The replacement, or nullptr to remove the application
+     */
+    static std::list<Device_ptr> withApplicationReplaced(
+            const std::list<Device_ptr> &devices,
+            const Device_ptr &device,
+            const Application_ptr &oldApplication,
+            const Application_ptr &newApplication
+    );
+
+    /* Same as withApplicationReplaced, adding one more application and keeping the applications sorted */
+    static std::list<Device_ptr> withApplicationAdded(
+            const std::list<Device_ptr> &devices,
+            const Device_ptr &device,
+            const Application_ptr &application
+    );
+};
+
+#endif
@@ -1,11 +1,22 @@
 #include "ConfigurationLoader.h"
 
 #include <fstream>
+#include <future>
+#include <libxml/parser.h>
 #include "DRIQuery.h"
 
+std::string ConfigurationLoader::getSystemWidePath() {
+    return "/etc/drirc";
+}
+
+std::string ConfigurationLoader::getUserDefinedPath() {
+    std::string userHome(std::getenv("HOME"));
+    return userHome + "/.drirc";
+}
+
 Glib::ustring ConfigurationLoader::readSystemWideXML() {
     std::ostringstream buffer;
-    std::ifstream input("/etc/drirc");
+    std::ifstream input(getSystemWidePath());
     buffer << input.rdbuf();
     Glib::ustring container(buffer.str());
 
@@ -15,8 +26,7 @@ Glib::ustring ConfigurationLoader::readSystemWideXML() {
 Glib::ustring ConfigurationLoader::readUserDefinedXML() {
     Glib::ustring container;
 
-    std::string userHome(std::getenv("HOME"));
-    std::ifstream input(userHome + "/.drirc");
+    std::ifstream input(getUserDefinedPath());
 
     if (!input.good()) {
         return container;
@@ -30,6 +40,10 @@ Glib::ustring ConfigurationLoader::readUserDefinedXML() {
     return container;
 }
 
+void ConfigurationLoader::setDisplay(Display *display) {
+    this->driQuery.setDisplay(display);
+}
+
 std::list<DriverConfiguration> ConfigurationLoader::loadDriverSpecificConfiguration(const Glib::ustring &locale) {
     return this->driQuery.queryDriverConfigurationOptions(locale);
 }
@@ -38,9 +52,13 @@ std::map<Glib::ustring, GPUInfo_ptr> ConfigurationLoader::loadAvailableGPUs() {
     return this->driQuery.enumerateDRIDevices();
 }
 
-Device_ptr ConfigurationLoader::loadSystemWideConfiguration() {
+Device_ptr ConfigurationLoader::loadSystemWideConfiguration(Glib::ustring *error) {
     Glib::ustring systemWideXML = this->readSystemWideXML();
-    std::list<Device_ptr> systemWideDevices = Parser::parseDevices(systemWideXML);
+    std::list<Device_ptr> systemWideDevices;
+
+    if (!systemWideXML.empty()) {
+        systemWideDevices = Parser::parseDevicesParallel(systemWideXML, 0, error);
+    }
 
     /* In case no configuration is available system-wide we generate an empty one */
     if (systemWideDevices.empty()) {
@@ -51,7 +69,72 @@ Device_ptr ConfigurationLoader::loadSystemWideConfiguration() {
     return systemWideDevices.front();
 }
 
-std::list<Device_ptr> ConfigurationLoader::loadUserDefinedConfiguration() {
+std::list<Device_ptr> ConfigurationLoader::loadUserDefinedConfiguration(Glib::ustring *error) {
     Glib::ustring userDefinedXML(this->readUserDefinedXML());
-    return Parser::parseDevices(userDefinedXML);
+    if (userDefinedXML.empty()) {
+        return std::list<Device_ptr>();
+    }
+
+    return Parser::parseDevicesParallel(userDefinedXML, 0, error);
+}
+
+ConfigurationLoader::Configuration ConfigurationLoader::loadConcurrently(
+        const Glib::ustring &locale,
+        unsigned int parts,
+        Glib::ustring *error
+) {
+    Configuration configuration;
+    /* One per task, as they run at the same time */
+    Glib::ustring systemWideError, userDefinedError;
+    bool reportErrors = error != nullptr;
+
+    /* libxml2 must be initialized before being used from several threads */
+    xmlInitParser();
+
+    /* Each task only touches its own result, and the driver query state is only read by the GPU task */
+    std::future<Device_ptr> systemWideTask;
+    std::future<std::list<Device_ptr>> userDefinedTask;
+    std::future<std::map<Glib::ustring, GPUInfo_ptr>> gpusTask;
+
+    if (parts & SYSTEM_WIDE) {
+        systemWideTask = std::async(std::launch::async, [this, reportErrors, &systemWideError] {
+            return this->loadSystemWideConfiguration(reportErrors ? &systemWideError : nullptr);
+        });
+    }
+
+    if (parts & USER_DEFINED) {
+        userDefinedTask = std::async(std::launch::async, [this, reportErrors, &userDefinedError] {
+            return this->loadUserDefinedConfiguration(reportErrors ? &userDefinedError : nullptr);
+        });
+    }
+
+    if (parts & GPUS) {
+        gpusTask = std::async(std::launch::async, [this] {
+            return this->loadAvailableGPUs();
+        });
+    }
+
+    if (parts & DRIVERS) {
+        configuration.driverConfiguration = this->loadDriverSpecificConfiguration(locale);
+    }
+
+    if (systemWideTask.valid()) {
+        configuration.systemWideConfiguration = systemWideTask.get();
+    }
+
+    if (userDefinedTask.valid()) {
+        configuration.userDefinedConfiguration = userDefinedTask.get();
+    }
+
+    if (gpusTask.valid()) {
+        configuration.availableGPUs = gpusTask.get();
+    }
+
+    if (reportErrors && !systemWideError.empty()) {
+        *error = Glib::ustring::compose("%1: %2", getSystemWidePath(), systemWideError);
+    } else if (reportErrors && !userDefinedError.empty()) {
+        *error = Glib::ustring::compose("%1: %2", getUserDefinedPath(), userDefinedError);
+    }
+
+    return configuration;
 }
@@ -11,21 +11,59 @@
 #include "DRIQuery.h"
 
 class ConfigurationLoader {
+public:
+    /* Parts of the configuration to load, combined as a bit mask */
+    enum Part : unsigned int {
+        DRIVERS = 1 << 0,
+        SYSTEM_WIDE = 1 << 1,
+        USER_DEFINED = 1 << 2,
+        GPUS = 1 << 3,
+        ALL = DRIVERS | SYSTEM_WIDE | USER_DEFINED | GPUS
+    };
+
+    /* Everything the editor starts from, the parts not requested are left empty */
+    struct Configuration {
+        std::list<DriverConfiguration> driverConfiguration;
+        Device_ptr systemWideConfiguration;
+        std::list<Device_ptr> userDefinedConfiguration;
+        std::map<Glib::ustring, GPUInfo_ptr> availableGPUs;
+    };
+
 private:
     Glib::ustring readSystemWideXML();
 
-    Glib::ustring readUserDefinedXML();
-
     DRIQuery driQuery;
 
 public:
+    static std::string getSystemWidePath();
+
+    static std::string getUserDefinedPath();
+
+    Glib::ustring readUserDefinedXML();
+
+    /* Reuse the X display of the toolkit to query the drivers */
+    void setDisplay(Display *display);
+
     std::list<DriverConfiguration> loadDriverSpecificConfiguration(const Glib::ustring &locale);
 
-    Device_ptr loadSystemWideConfiguration();
+    /* A missing or empty file is an empty configuration, for the error see Parser::parseDevices */
+    Device_ptr loadSystemWideConfiguration(Glib::ustring *error = nullptr);
 
-    std::list<Device_ptr> loadUserDefinedConfiguration();
+    std::list<Device_ptr> loadUserDefinedConfiguration(Glib::ustring *error = nullptr);
 
     std::map<Glib::ustring, GPUInfo_ptr> loadAvailableGPUs();
+
+    /**
+     * Load several parts at once, each one as an independent task
+     * The drirc files are read and parsed, and the GPUs enumerated, on worker threads while the drivers
+     * are queried on the calling thread: GLX must stay on the thread that owns the X display.
+     * Everything is joined before returning, so the resolver steps can follow directly.
+     * @param locale Used for the driver option descriptions
+     * @param parts Combination of Part values
+     * @param error When given, receives the error of a drirc file that can't be parsed, see Parser::parseDevices
+     */
+    Configuration loadConcurrently(const Glib::ustring &locale, unsigned int parts = ALL,
+                                   Glib::ustring *error = nullptr);
 };
 
 #endif
@@ -1,6 +1,32 @@
 #include "ConfigurationResolver.h"
-#include "Parser.h"
 #include <glibmm/i18n.h>
+#include "Counters.h"
+
+namespace {
+    const DriverOption *findDriverOption(const DriverSchema_ptr &schema, const Glib::ustring &name) {
+        if (schema == nullptr) {
+            return nullptr;
+        }
+
+        return schema->findOption(name);
+    }
+
+    /* The value an application gives to each option of the driver, by ordinal, null when it doesn't set it */
+    std::vector<const Glib::ustring *> indexOptionValues(const DriverSchema &schema, const Application &application) {
+        std::vector<const Glib::ustring *> values(schema.getOptions().size(), nullptr);
+
+        for (const auto &option : application.getOptions()) {
+            auto ordinal = schema.findOrdinal(option->getName());
+
+            /* The last occurrence wins, as options are applied in order (here, when displayed and by Mesa) */
+            if (ordinal != DRIVER_SCHEMA_NO_ORDINAL) {
+                values[ordinal] = &option->getValue();
+            }
+        }
+
+        return values;
+    }
+}
 
 std::list<Device_ptr> ConfigurationResolver::resolveOptionsForSave(
         const Device_ptr &systemWideDevice,
@@ -9,6 +35,9 @@ std::list<Device_ptr> ConfigurationResolver::resolveOptionsForSave(
 ) {
     /* Create the final driverList */
     std::list<Device_ptr> mergedDevices;
+    /* Counted locally, so parallel saves don't fight over the counters */
+    uint64_t comparisons = 0;
+    uint64_t allocatedOptions = 0;
 
     /* Precedence: userDefined > System Wide > Driver Default */
     for (const auto &userDefinedDevice : userDefinedDevices) {
@@ -18,42 +47,68 @@ std::list<Device_ptr> ConfigurationResolver::resolveOptionsForSave(
         mergedDevice->setScreen(userDefinedDevice->getScreen());
 
         auto driverConfig = std::find_if(driverAvailableOptions.begin(), driverAvailableOptions.end(),
-                                         [&userDefinedDevice](const DriverConfiguration &d) {
-                                             return d.getScreen() == userDefinedDevice->getScreen();
+                                         [&userDefinedDevice, &comparisons](const DriverConfiguration &d) {
+                                             comparisons++;
+                                             return d.getScreen() == userDefinedDevice->getScreen()
+                                                    && d.getDriver() == userDefinedDevice->getDriver();
                                          });
 
-        std::list<DriverOption> driverOptions;
+        DriverSchema_ptr driverSchema = nullptr;
 
         if (driverConfig != driverAvailableOptions.end()) {
-            driverOptions = Parser::convertSectionsToOptionsObject(driverConfig->getSections());
+            driverSchema = driverConfig->getSchema();
         }
 
         for (const auto &userDefinedApplication : userDefinedDevice->getApplications()) {
             auto mergedApp = std::make_shared<Application>();
-            mergedApp->setExecutable(userDefinedApplication->getExecutable());
+            mergedApp->setMatchRules(*userDefinedApplication);
             mergedApp->setName(userDefinedApplication->getName());
 
-            auto systemWideApp = systemWideDevice->findApplication(userDefinedApplication->getExecutable());
+            auto systemWideApp = systemWideDevice->findEquivalentApplication(*userDefinedApplication);
 
             /* If this application already exists systemWide, we need to do a merge on it */
             if (systemWideApp != nullptr) {
                 bool addApplication = false;
 
-                /* List of name-value options */
-                auto systemWideAppOptions = systemWideApp->getOptions();
-
+                /* Options resolved once to their ordinal, those the driver doesn't know are searched by name */
+                const auto &systemWideAppOptions = systemWideApp->getOptions();
+                std::vector<const Glib::ustring *> systemWideValues;
+                if (driverSchema != nullptr) {
+                    systemWideValues = indexOptionValues(*driverSchema, *systemWideApp);
+                }
 
                 for (auto const &userDefinedAppOption : userDefinedApplication->getOptions()) {
-                    auto systemWideAppOption = std::find_if(systemWideAppOptions.begin(), systemWideAppOptions.end(),
-                                                            [&userDefinedAppOption](ApplicationOption_ptr a) {
-                                                                return a->getName() == userDefinedAppOption->getName();
-                                                            });
+                    const Glib::ustring *systemWideValue = nullptr;
+                    auto ordinal = DRIVER_SCHEMA_NO_ORDINAL;
+
+                    if (driverSchema != nullptr) {
+                        ordinal = driverSchema->findOrdinal(userDefinedAppOption->getName());
+                    }
+
+                    if (ordinal != DRIVER_SCHEMA_NO_ORDINAL) {
+                        comparisons++;
+                        systemWideValue = systemWideValues[ordinal];
+                    } else {
+                        /* Searched from the end, so the last occurrence wins here too */
+                        auto systemWideAppOption = std::find_if(systemWideAppOptions.rbegin(), systemWideAppOptions.rend(),
+                                                                [&userDefinedAppOption, &comparisons](const ApplicationOption_ptr &a) {
+                                                                    comparisons++;
+                                                                    return a->getName() == userDefinedAppOption->getName();
+                                                                });
+
+                        if (systemWideAppOption != systemWideAppOptions.rend()) {
+                            systemWideValue = &(*systemWideAppOption)->getValue();
+                        }
+                    }
+
+                    if (systemWideValue != nullptr) {
+                        comparisons++;
 
-                    if (systemWideAppOption != systemWideAppOptions.end()) {
                         /* If the option set is the same as the one used just ignore this options*/
-                        if ((*systemWideAppOption)->getValue() != userDefinedAppOption->getValue()) {
+                        if (*systemWideValue != userDefinedAppOption->getValue()) {
                             addApplication = true;
                             auto newMergedOption = std::make_shared<ApplicationOption>();
+                            allocatedOptions++;
                             newMergedOption->setName(userDefinedAppOption->getName());
                             newMergedOption->setValue(userDefinedAppOption->getValue());
                             mergedApp->addOption(newMergedOption);
@@ -63,15 +118,17 @@ std::list<Device_ptr> ConfigurationResolver::resolveOptionsForSave(
                          * DriverOption doesn't exist in system-wide
                          * We must check what is the default value from driver
                          */
-                        auto driverOption = std::find_if(driverOptions.begin(), driverOptions.end(),
-                                                         [&userDefinedAppOption](const DriverOption &d) {
-                                                             return d.getName() == userDefinedAppOption->getName();
-                                                         });
+                        const DriverOption *driverOption = nullptr;
+                        if (ordinal != DRIVER_SCHEMA_NO_ORDINAL) {
+                            driverOption = driverSchema->getOptions()[ordinal];
+                        }
 
-                        if (driverOption->getDefaultValue() != userDefinedAppOption->getValue()) {
+                        if (driverOption == nullptr
+                            || driverOption->getDefaultValue() != userDefinedAppOption->getValue()) {
                             addApplication = true;
 
                             auto newMergedOption = std::make_shared<ApplicationOption>();
+                            allocatedOptions++;
                             newMergedOption->setName(userDefinedAppOption->getName());
                             newMergedOption->setValue(userDefinedAppOption->getValue());
                             mergedApp->addOption(newMergedOption);
@@ -90,13 +147,12 @@ std::list<Device_ptr> ConfigurationResolver::resolveOptionsForSave(
                  */
 
                 for (auto &userDefinedAppOption : userDefinedApplication->getOptions()) {
-                    auto driverOption = std::find_if(driverOptions.begin(), driverOptions.end(),
-                                                     [&userDefinedAppOption](DriverOption &d) {
-                                                         return d.getName() == userDefinedAppOption->getName();
-                                                     });
+                    auto driverOption = findDriverOption(driverSchema, userDefinedAppOption->getName());
 
-                    if (driverOption->getDefaultValue() != userDefinedAppOption->getValue()) {
+                    if (driverOption == nullptr
+                        || driverOption->getDefaultValue() != userDefinedAppOption->getValue()) {
                         auto newMergedOption = std::make_shared<ApplicationOption>();
+                        allocatedOptions++;
                         newMergedOption->setName(userDefinedAppOption->getName());
                         newMergedOption->setValue(userDefinedAppOption->getValue());
                         mergedApp->addOption(newMergedOption);
@@ -110,6 +166,9 @@ std::list<Device_ptr> ConfigurationResolver::resolveOptionsForSave(
         mergedDevices.emplace_back(mergedDevice);
     }
 
+    Counters::add(Counters::Counter::RESOLVER_COMPARISONS, comparisons);
+    Counters::add(Counters::Counter::OPTIONS_ALLOCATED, allocatedOptions);
+
     return mergedDevices;
 }
 
@@ -145,6 +204,8 @@ void ConfigurationResolver::filterDriverUnsupportedOptions(
         }
     }
 
+    uint64_t filteredOptions = 0;
+
     for (auto &userDefinedDevice : userDefinedDevices) {
         auto driverConfig = std::find_if(driverAvailableOptions.begin(), driverAvailableOptions.end(),
                                          [&userDefinedDevice](const DriverConfiguration &d) {
@@ -155,10 +216,10 @@ void ConfigurationResolver::filterDriverUnsupportedOptions(
                                              );
                                          });
 
-        std::list<Glib::ustring> driverOptions;
+        DriverSchema_ptr driverSchema = nullptr;
 
         if (driverConfig != driverAvailableOptions.end()) {
-            driverOptions = Parser::convertSectionsToOptions(driverConfig->getSections());
+            driverSchema = driverConfig->getSchema();
         }
 
         auto userDefinedApplications = userDefinedDevice->getApplications();
@@ -167,9 +228,7 @@ void ConfigurationResolver::filterDriverUnsupportedOptions(
 
             auto itr = options.begin();
             while (itr != options.end()) {
-                auto driverSupports = std::find(driverOptions.begin(), driverOptions.end(), (*itr)->getName());
-
-                if (driverSupports == driverOptions.end()) {
+                if (findDriverOption(driverSchema, (*itr)->getName()) == nullptr) {
                     std::cerr << Glib::ustring::compose(
                             _("Driver '%1' doesn't support option '%2' on application '%3'. Option removed."),
                             driverConfig->getDriver(),
@@ -177,6 +236,7 @@ void ConfigurationResolver::filterDriverUnsupportedOptions(
                             userDefinedApp->getName()
                     ) << std::endl;
                     itr = options.erase(itr);
+                    filteredOptions++;
                 } else {
                     ++itr;
                 }
@@ -186,7 +246,7 @@ void ConfigurationResolver::filterDriverUnsupportedOptions(
         }
     }
 
-
+    Counters::add(Counters::Counter::OPTIONS_FILTERED, filteredOptions);
 }
 
 void ConfigurationResolver::mergeOptionsForDisplay(
@@ -194,6 +254,8 @@ void ConfigurationResolver::mergeOptionsForDisplay(
         const std::list<DriverConfiguration> &driverAvailableOptions,
         std::list<Device_ptr> &userDefinedOptions
 ) {
+    uint64_t comparisons = 0;
+
     for (const auto &driverConf : driverAvailableOptions) {
         /* Check if user-config has any config for this screen/driver */
         auto userSearchDefinedDevice = std::find_if(userDefinedOptions.begin(), userDefinedOptions.end(),
@@ -214,65 +276,19 @@ void ConfigurationResolver::mergeOptionsForDisplay(
             userDefinedDevice = *userSearchDefinedDevice;
         }
 
-        auto driverOptions = Parser::convertSectionsToOptionsObject(driverConf.getSections());
-
         auto newDeviceApps = userDefinedDevice->getApplications();
 
-        /* Check if the user-defined apps are missing any of the driver option */
-        for (auto &userDefinedApp : newDeviceApps) {
-            for (const auto &driverDefinedOption : driverOptions) {
-                auto optionExists = std::find_if(userDefinedApp->getOptions().begin(),
-                                                 userDefinedApp->getOptions().end(),
-                                                 [&driverDefinedOption](ApplicationOption_ptr o) {
-                                                     return o->getName() == driverDefinedOption.getName();
-
-                                                 });
-                /* Option doesn't exists, lets add it */
-                if (optionExists == userDefinedApp->getOptions().end()) {
-                    auto newDriverOpt = std::make_shared<ApplicationOption>();
-                    newDriverOpt->setName(driverDefinedOption.getName());
-                    newDriverOpt->setValue(driverDefinedOption.getDefaultValue());
-
-                    userDefinedApp->addOption(newDriverOpt);
-                }
-            }
-        }
-
-
-        /* Check if we can add any of the system-wide apps for this config */
+        /*
+         * Make the system-wide apps selectable for this config
+         * They carry no options, their values are resolved from the system-wide layer when displayed
+         */
         for (const auto &systemWideApp : systemWideDevice->getApplications()) {
-            auto appExists = std::find_if(newDeviceApps.begin(), newDeviceApps.end(),
-                                          [&systemWideApp](Application_ptr app) {
-                                              return app->getExecutable() == systemWideApp->getExecutable();
-                                          });
+            comparisons++;
 
-            if (appExists == newDeviceApps.end()) {
+            if (userDefinedDevice->findEquivalentApplication(*systemWideApp) == nullptr) {
                 auto systemDefinedApp = std::make_shared<Application>();
                 systemDefinedApp->setName(systemWideApp->getName());
-                systemDefinedApp->setExecutable(systemWideApp->getExecutable());
-
-                for (const auto &driverOptionObj : driverOptions) {
-                    auto optionExists = std::find_if(systemWideApp->getOptions().begin(),
-                                                     systemWideApp->getOptions().end(),
-                                                     [&driverOptionObj](ApplicationOption_ptr a) {
-                                                         return driverOptionObj.getName() == a->getName();
-                                                     });
-
-                    if (optionExists == systemWideApp->getOptions().end()) {
-                        auto newDriverOpt = std::make_shared<ApplicationOption>();
-                        newDriverOpt->setName(driverOptionObj.getName());
-                        newDriverOpt->setValue(driverOptionObj.getDefaultValue());
-
-                        systemDefinedApp->addOption(newDriverOpt);
-                    } else {
-                        /* Option already exists, lets add it */
-                        auto newDriverOpt = std::make_shared<ApplicationOption>();
-                        newDriverOpt->setName((*optionExists)->getName());
-                        newDriverOpt->setValue((*optionExists)->getValue());
-
-                        systemDefinedApp->addOption(newDriverOpt);
-                    }
-                }
+                systemDefinedApp->setMatchRules(*systemWideApp);
 
                 userDefinedDevice->addApplication(systemDefinedApp);
             }
@@ -281,20 +297,12 @@ void ConfigurationResolver::mergeOptionsForDisplay(
         /* Check if we have a default config */
         auto defaultApp = std::find_if(newDeviceApps.begin(), newDeviceApps.end(),
                                        [](Application_ptr app) {
-                                           return app->getExecutable().empty();
+                                           return app->isDefault();
                                        });
 
         if (defaultApp == newDeviceApps.end()) {
             auto defaultApplication = std::make_shared<Application>();
             defaultApplication->setName("Default");
-            auto defaultAppOptions = defaultApplication->getOptions();
-            for (auto &driverOptionObj : driverOptions) {
-                auto newDriverOpt = std::make_shared<ApplicationOption>();
-                newDriverOpt->setName(driverOptionObj.getName());
-                newDriverOpt->setValue(driverOptionObj.getDefaultValue());
-
-                defaultApplication->addOption(newDriverOpt);
-            }
 
             userDefinedDevice->addApplication(defaultApplication);
         }
@@ -303,4 +311,46 @@ void ConfigurationResolver::mergeOptionsForDisplay(
             userDefinedOptions.emplace_back(userDefinedDevice);
         }
     }
-}
\ No newline at end of file
+
+    Counters::add(Counters::Counter::RESOLVER_COMPARISONS, comparisons);
+}
+
+std::vector<Glib::ustring> ConfigurationResolver::resolveApplicationOptions(
+        const Device_ptr &systemWideDevice,
+        const DriverConfiguration &driverConfiguration,
+        const Application &application
+) {
+    std::vector<Glib::ustring> resolvedOptions;
+
+    const auto &schema = driverConfiguration.getSchema();
+    if (schema == nullptr) {
+        return resolvedOptions;
+    }
+
+    /* Driver default */
+    resolvedOptions.reserve(schema->getOptions().size());
+    for (const auto &option : schema->getOptions()) {
+        resolvedOptions.emplace_back(option->getDefaultValue());
+    }
+
+    /* System-wide, only for the options this driver supports */
+    auto systemWideApp = systemWideDevice->findEquivalentApplication(application);
+    if (systemWideApp != nullptr) {
+        for (const auto &option : systemWideApp->getOptions()) {
+            auto ordinal = schema->findOrdinal(option->getName());
+            if (ordinal != DRIVER_SCHEMA_NO_ORDINAL) {
+                resolvedOptions[ordinal] = option->getValue();
+            }
+        }
+    }
+
+    /* User-defined overrides */
+    for (const auto &option : application.getOptions()) {
+        auto ordinal = schema->findOrdinal(option->getName());
+        if (ordinal != DRIVER_SCHEMA_NO_ORDINAL) {
+            resolvedOptions[ordinal] = option->getValue();
+        }
+    }
+
+    return resolvedOptions;
+}
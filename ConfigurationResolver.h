@@ -2,6 +2,7 @@
 #define DRICONF3_CONFIGURATIONRESOLVER_H
 
 #include <list>
+#include <vector>
 #include <glibmm/ustring.h>
 #include "Device.h"
 #include <algorithm>
@@ -35,7 +36,8 @@ namespace ConfigurationResolver {
     );
 
     /**
-     * Merge all the options defined in system-wide config together with the user-defined ones
+     * Make sure every driver has a user-defined device with a default application and the system-wide applications
+     * Applications only hold the options the user overrides, see resolveApplicationOptions for the displayed values
      * This function will directly change the userDefinedOptions list passed as argument
      * @param systemWideOptions
      * @param driverAvailableOptions
@@ -46,6 +48,20 @@ namespace ConfigurationResolver {
             const std::list<DriverConfiguration> &,
             std::list<Device_ptr> &
     );
+
+    /**
+     * Resolve the effective value of every driver option for one application
+     * Precedence: userDefined > System Wide > Driver Default
+     * @param systemWideOptions
+     * @param driverConfiguration The driver the application is being displayed for
+     * @param application The user-defined application, holding only its overrides
+     * @return The value of each option, indexed by its ordinal in the driver schema (empty without a schema)
+     */
+    std::vector<Glib::ustring> resolveApplicationOptions(
+            const Device_ptr &,
+            const DriverConfiguration &,
+            const Application &
+    );
 };
 
 
@@ -0,0 +1,193 @@
+#include "ConfigurationSaver.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <glibmm/i18n.h>
+#include "ConfigurationDiff.h"
+#include "ConfigurationLoader.h"
+#include "ConfigurationResolver.h"
+#include "ConfigurationValidator.h"
+#include "LaunchIndexBuilder.h"
+#include "Parser.h"
+#include "Writer.h"
+
+namespace {
+    /**
+     * Write the content next to the file and rename it over, so the file is never seen half written
+     * A symbolic link is followed and the mode of the file is kept, as writing it in place would do.
+     * The temporary name holds the process id, so two processes saving at once don't share it.
+     */
+    bool replaceFile(const std::string &path, const Glib::ustring &content) {
+        std::string targetPath(path);
+        char resolvedPath[PATH_MAX];
+        if (realpath(path.c_str(), resolvedPath) != nullptr) {
+            targetPath = resolvedPath;
+        }
+
+        std::string temporaryPath(targetPath + ".tmp" + std::to_string(getpid()));
+        std::ofstream outFile(temporaryPath);
+        outFile << content;
+        outFile.close();
+
+        struct stat targetStat;
+        if (!outFile.fail() && stat(targetPath.c_str(), &targetStat) == 0) {
+            chmod(temporaryPath.c_str(), targetStat.st_mode & 07777);
+        }
+
+        if (outFile.fail() || std::rename(temporaryPath.c_str(), targetPath.c_str()) != 0) {
+            int writeError = errno;
+            std::remove(temporaryPath.c_str());
+            errno = writeError;
+            return false;
+        }
+
+        return true;
+    }
+}
+
+ConfigurationSaver::ConfigurationSaver() {
+    this->dispatcher.connect(sigc::mem_fun(this, &ConfigurationSaver::onWorkerFinished));
+}
+
+ConfigurationSaver::~ConfigurationSaver() {
+    if (this->worker.joinable()) {
+        this->worker.join();
+    }
+
+    if (this->pendingJob) {
+        auto pendingResult = run(*this->pendingJob);
+
+        if (pendingResult.state == State::FAILED) {
+            std::cerr << pendingResult.error << std::endl;
+        }
+    }
+}
+
+void ConfigurationSaver::save(
+        const Device_ptr &systemWideConfiguration,
+        const std::list<DriverConfiguration> &driverConfiguration,
+        const std::list<Device_ptr> &userDefinedConfiguration
+) {
+    /* Only the device list and the driver list are copied, everything they point to is shared */
+    std::unique_ptr<Job> job(new Job);
+    job->systemWideConfiguration = systemWideConfiguration;
+    job->driverConfiguration = driverConfiguration;
+    job->userDefinedConfiguration = userDefinedConfiguration;
+
+    if (this->isSaving()) {
+        this->pendingJob = std::move(job);
+        return;
+    }
+
+    this->start(std::move(job));
+}
+
+bool ConfigurationSaver::isSaving() const {
+    return this->worker.joinable();
+}
+
+sigc::signal<void, const ConfigurationSaver::Result &> &ConfigurationSaver::signalFinished() {
+    return this->finishedSignal;
+}
+
+void ConfigurationSaver::start(std::unique_ptr<Job> job) {
+    std::shared_ptr<Job> runningJob(std::move(job));
+
+    this->worker = std::thread([this, runningJob]() {
+        this->result = run(*runningJob);
+        this->dispatcher.emit();
+    });
+}
+
+void ConfigurationSaver::onWorkerFinished() {
+    this->worker.join();
+    Result finishedResult(std::move(this->result));
+
+    if (this->pendingJob) {
+        this->start(std::move(this->pendingJob));
+    }
+
+    this->finishedSignal.emit(finishedResult);
+}
+
+ConfigurationSaver::Result ConfigurationSaver::run(const Job &job) {
+    auto result = writeFile(
+            job.systemWideConfiguration, job.driverConfiguration, job.userDefinedConfiguration,
+            ConfigurationLoader::getUserDefinedPath()
+    );
+
+    if (result.state == State::WRITTEN) {
+        LaunchIndexBuilder::refresh(
+                job.systemWideConfiguration, job.driverConfiguration, job.userDefinedConfiguration
+        );
+    }
+
+    return result;
+}
+
+ConfigurationSaver::Result ConfigurationSaver::writeFile(
+        const Device_ptr &systemWideConfiguration,
+        const std::list<DriverConfiguration> &driverConfiguration,
+        const std::list<Device_ptr> &userDefinedConfiguration,
+        const std::string &path
+) {
+    Result result;
+    result.state = State::FAILED;
+
+    try {
+        auto resolvedOptions = ConfigurationResolver::resolveOptionsForSave(
+                systemWideConfiguration, driverConfiguration, userDefinedConfiguration
+        );
+        ConfigurationDiff::canonicalize(resolvedOptions);
+
+        for (const auto &diagnostic : ConfigurationValidator::validate(driverConfiguration, resolvedOptions)) {
+            result.messages.emplace_back(ConfigurationValidator::describe(diagnostic));
+        }
+
+        auto rawXML = Writer::generateRawXml(resolvedOptions);
+
+        /* Avoid touching the file when nothing changed, as it triggers watchers and backups */
+        Glib::ustring currentXML;
+        std::ifstream input(path);
+        if (input.good()) {
+            std::ostringstream buffer;
+            buffer << input.rdbuf();
+            currentXML = buffer.str();
+        }
+
+        if (currentXML.raw() == rawXML.raw()) {
+            result.state = State::UNCHANGED;
+            return result;
+        }
+
+        std::list<Device_ptr> currentDevices;
+        if (!currentXML.empty()) {
+            currentDevices = Parser::parseDevices(currentXML);
+        }
+
+        for (const auto &change : ConfigurationDiff::compare(currentDevices, resolvedOptions)) {
+            result.messages.emplace_back(ConfigurationDiff::describe(change));
+        }
+
+        if (!replaceFile(path, rawXML)) {
+            result.error = Glib::ustring::compose(
+                    _("Couldn't write %1: %2"), path, std::strerror(errno)
+            );
+            return result;
+        }
+
+        result.state = State::WRITTEN;
+    } catch (const std::exception &ex) {
+        result.error = ex.what();
+    }
+
+    return result;
+}
@@ -0,0 +1,100 @@
+#ifndef ADRICONF_CONFIGURATIONSAVER_H
+#define ADRICONF_CONFIGURATIONSAVER_H
+
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <glibmm/dispatcher.h>
+#include <glibmm/ustring.h>
+#include <sigc++/sigc++.h>
+#include "Device.h"
+#include "DriverConfiguration.h"
+
+/**
+ * Resolves and writes the user configuration on a worker thread
+ * The configuration must be an immutable snapshot (see ConfigurationHistory), so it is shared with the worker
+ * without copying. Only one save runs at a time: a save requested meanwhile waits as the single pending one,
+ * replacing any older pending snapshot.
+ * Every public method must be called from the main loop, where the finished signal is also emitted.
+ */
+class ConfigurationSaver {
+public:
+    enum class State {
+        WRITTEN,
+        UNCHANGED,
+        FAILED
+    };
+
+    struct Result {
+        State state;
+        /* Diagnostics and changes, to be logged by the caller */
+        std::list<Glib::ustring> messages;
+        Glib::ustring error;
+    };
+
+private:
+    struct Job {
+        Device_ptr systemWideConfiguration;
+        std::list<DriverConfiguration> driverConfiguration;
+        std::list<Device_ptr> userDefinedConfiguration;
+    };
+
+    Glib::Dispatcher dispatcher;
+    std::thread worker;
+    /* Written by the worker, read only after it is joined */
+    Result result;
+    std::unique_ptr<Job> pendingJob;
+    sigc::signal<void, const Result &> finishedSignal;
+
+    /* Write the user-defined file and keep the launch index in sync with it */
+    static Result run(const Job &job);
+
+    void start(std::unique_ptr<Job> job);
+
+    void onWorkerFinished();
+
+public:
+    ConfigurationSaver();
+
+    /* Waits for the running save and writes the pending one, so no change is lost on exit */
+    virtual ~ConfigurationSaver();
+
+    /**
+     * Save the given snapshot in the background
+     * @param systemWideConfiguration
+     * @param driverConfiguration
+     * @param userDefinedConfiguration Must not be changed after this call
+     */
+    void save(
+            const Device_ptr &systemWideConfiguration,
+            const std::list<DriverConfiguration> &driverConfiguration,
+            const std::list<Device_ptr> &userDefinedConfiguration
+    );
+
+    bool isSaving() const;
+
+    sigc::signal<void, const Result &> &signalFinished();
+
+    /**
+     * Resolve the configuration and write it to a file, on the calling thread
+     * The file is left untouched when it already has the same contents.
+     * Only reads its arguments, so many files can be written in parallel from the same base.
+     * @param systemWideConfiguration
+     * @param driverConfiguration
+     * @param userDefinedConfiguration
+     * @param path
+     */
+    static Result writeFile(
+            const Device_ptr &systemWideConfiguration,
+            const std::list<DriverConfiguration> &driverConfiguration,
+            const std::list<Device_ptr> &userDefinedConfiguration,
+            const std::string &path
+    );
+
+    ConfigurationSaver(const ConfigurationSaver &) = delete;
+
+    ConfigurationSaver &operator=(const ConfigurationSaver &) = delete;
+};
+
+#endif
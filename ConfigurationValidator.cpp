@@ -0,0 +1,286 @@
+#include "ConfigurationValidator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <glibmm/i18n.h>
+
+namespace {
+    enum class OptionType {
+        BOOL,
+        ENUM,
+        INT,
+        FLOAT,
+        STRING
+    };
+
+    struct Range {
+        double start;
+        double end;
+    };
+
+    struct CompiledOption {
+        OptionType type;
+        std::vector<Range> ranges;
+        std::unordered_set<long> enumValues;
+        const DriverOption *option;
+    };
+
+    typedef std::unordered_map<std::string, CompiledOption> CompiledSchema;
+
+    bool parseInteger(const std::string &value, long &result) {
+        if (value.empty()) {
+            return false;
+        }
+
+        char *end = nullptr;
+        errno = 0;
+        result = std::strtol(value.c_str(), &end, 0);
+
+        return errno == 0 && *end == '\0';
+    }
+
+    bool parseFloat(const std::string &value, double &result) {
+        if (value.empty()) {
+            return false;
+        }
+
+        char *end = nullptr;
+        errno = 0;
+        result = std::strtod(value.c_str(), &end);
+
+        return errno == 0 && *end == '\0';
+    }
+
+    /* Mesa accepts a comma-separated list of "start:end" ranges, or single values */
+    std::vector<Range> parseRanges(const std::string &validValues) {
+        std::vector<Range> ranges;
+        std::size_t start = 0;
+
+        while (start < validValues.length()) {
+            auto end = validValues.find(',', start);
+            if (end == std::string::npos) {
+                end = validValues.length();
+            }
+
+            auto range = validValues.substr(start, end - start);
+            auto splitPos = range.find(':');
+            Range parsedRange;
+
+            if (splitPos == std::string::npos) {
+                if (parseFloat(range, parsedRange.start)) {
+                    parsedRange.end = parsedRange.start;
+                    ranges.emplace_back(parsedRange);
+                }
+            } else if (parseFloat(range.substr(0, splitPos), parsedRange.start)
+                       && parseFloat(range.substr(splitPos + 1), parsedRange.end)) {
+                ranges.emplace_back(parsedRange);
+            }
+
+            start = end + 1;
+        }
+
+        return ranges;
+    }
+
+    CompiledSchema compileSchema(const DriverSchema &driverSchema) {
+        CompiledSchema schema;
+        schema.reserve(driverSchema.getOptions().size());
+
+        for (const auto driverOptionPtr : driverSchema.getOptions()) {
+            const auto &driverOption = *driverOptionPtr;
+            CompiledOption compiled;
+            compiled.option = &driverOption;
+            compiled.ranges = parseRanges(driverOption.getValidValues().raw());
+
+            if (driverOption.getType() == "bool") {
+                compiled.type = OptionType::BOOL;
+            } else if (driverOption.getType() == "enum") {
+                compiled.type = OptionType::ENUM;
+            } else if (driverOption.getType() == "int") {
+                compiled.type = OptionType::INT;
+            } else if (driverOption.getType() == "float") {
+                compiled.type = OptionType::FLOAT;
+            } else {
+                compiled.type = OptionType::STRING;
+            }
+
+            for (const auto &enumValue : driverOption.getEnumValues()) {
+                long value;
+                if (parseInteger(enumValue.second.raw(), value)) {
+                    compiled.enumValues.insert(value);
+                }
+            }
+
+            schema[driverOption.getName().raw()] = compiled;
+        }
+
+        return schema;
+    }
+
+    bool inRanges(const std::vector<Range> &ranges, double value) {
+        if (ranges.empty()) {
+            return true;
+        }
+
+        return std::any_of(ranges.begin(), ranges.end(), [value](const Range &range) {
+            return value >= range.start && value <= range.end;
+        });
+    }
+
+    /* Check the value, returning true if it is valid */
+    bool checkValue(const CompiledOption &compiled, const Glib::ustring &value, ConfigurationValidator::Problem &problem) {
+        long integerValue;
+        double floatValue;
+
+        switch (compiled.type) {
+            case OptionType::BOOL:
+                problem = ConfigurationValidator::Problem::INVALID_TYPE;
+                return value == "true" || value == "false";
+
+            case OptionType::ENUM:
+                if (!parseInteger(value.raw(), integerValue)) {
+                    problem = ConfigurationValidator::Problem::INVALID_TYPE;
+                    return false;
+                }
+
+                if (!compiled.enumValues.empty()) {
+                    problem = ConfigurationValidator::Problem::INVALID_ENUM_VALUE;
+                    return compiled.enumValues.count(integerValue) > 0;
+                }
+
+                problem = ConfigurationValidator::Problem::OUT_OF_RANGE;
+                return inRanges(compiled.ranges, integerValue);
+
+            case OptionType::INT:
+                if (!parseInteger(value.raw(), integerValue)) {
+                    problem = ConfigurationValidator::Problem::INVALID_TYPE;
+                    return false;
+                }
+
+                problem = ConfigurationValidator::Problem::OUT_OF_RANGE;
+                return inRanges(compiled.ranges, integerValue);
+
+            case OptionType::FLOAT:
+                if (!parseFloat(value.raw(), floatValue)) {
+                    problem = ConfigurationValidator::Problem::INVALID_TYPE;
+                    return false;
+                }
+
+                problem = ConfigurationValidator::Problem::OUT_OF_RANGE;
+                return inRanges(compiled.ranges, floatValue);
+
+            case OptionType::STRING:
+            default:
+                return true;
+        }
+    }
+
+    Glib::ustring expectedValues(const DriverOption &option) {
+        if (!option.getEnumValues().empty()) {
+            Glib::ustring values;
+            for (const auto &enumValue : option.getEnumValues()) {
+                if (!values.empty()) {
+                    values.append(", ");
+                }
+                values.append(enumValue.second);
+            }
+
+            return values;
+        }
+
+        if (!option.getValidValues().empty()) {
+            return option.getType() + " " + option.getValidValues();
+        }
+
+        return option.getType();
+    }
+}
+
+std::list<ConfigurationValidator::Diagnostic> ConfigurationValidator::validate(
+        const std::list<DriverConfiguration> &driverAvailableOptions,
+        const std::list<Device_ptr> &devices
+) {
+    std::list<Diagnostic> diagnostics;
+    std::map<const DriverSchema *, CompiledSchema> compiledSchemas;
+
+    for (const auto &device : devices) {
+        auto driverConfig = std::find_if(driverAvailableOptions.begin(), driverAvailableOptions.end(),
+                                         [&device](const DriverConfiguration &d) {
+                                             return d.getDriver() == device->getDriver()
+                                                    && d.getScreen() == device->getScreen();
+                                         });
+
+        if (driverConfig == driverAvailableOptions.end()) {
+            continue;
+        }
+
+        if (driverConfig->getSchema() == nullptr) {
+            continue;
+        }
+
+        /* Every device of the same driver shares the schema, so it is compiled only once */
+        auto &schema = compiledSchemas[driverConfig->getSchema().get()];
+        if (schema.empty()) {
+            schema = compileSchema(*driverConfig->getSchema());
+        }
+
+        for (const auto &application : device->getApplications()) {
+            for (const auto &option : application->getOptions()) {
+                Diagnostic diagnostic;
+                auto compiled = schema.find(option->getName().raw());
+
+                if (compiled == schema.end()) {
+                    diagnostic.problem = Problem::UNKNOWN_OPTION;
+                } else if (checkValue(compiled->second, option->getValue(), diagnostic.problem)) {
+                    continue;
+                } else {
+                    diagnostic.expected = expectedValues(*compiled->second.option);
+                }
+
+                diagnostic.driver = device->getDriver();
+                diagnostic.screen = device->getScreen();
+                diagnostic.application = application->getName();
+                diagnostic.option = option->getName();
+                diagnostic.value = option->getValue();
+
+                diagnostics.emplace_back(diagnostic);
+            }
+        }
+    }
+
+    return diagnostics;
+}
+
+Glib::ustring ConfigurationValidator::describe(const ConfigurationValidator::Diagnostic &diagnostic) {
+    switch (diagnostic.problem) {
+        case Problem::UNKNOWN_OPTION:
+            return Glib::ustring::compose(
+                    _("Driver '%1' doesn't support option '%2' on application '%3'."),
+                    diagnostic.driver, diagnostic.option, diagnostic.application
+            );
+        case Problem::INVALID_TYPE:
+            return Glib::ustring::compose(
+                    _("Invalid value '%1' for option '%2' on application '%3' of driver '%4'. Expected: %5"),
+                    diagnostic.value, diagnostic.option, diagnostic.application, diagnostic.driver,
+                    diagnostic.expected
+            );
+        case Problem::INVALID_ENUM_VALUE:
+            return Glib::ustring::compose(
+                    _("Value '%1' of option '%2' on application '%3' of driver '%4' is not one of: %5"),
+                    diagnostic.value, diagnostic.option, diagnostic.application, diagnostic.driver,
+                    diagnostic.expected
+            );
+        case Problem::OUT_OF_RANGE:
+        default:
+            return Glib::ustring::compose(
+                    _("Value '%1' of option '%2' on application '%3' of driver '%4' is out of range: %5"),
+                    diagnostic.value, diagnostic.option, diagnostic.application, diagnostic.driver,
+                    diagnostic.expected
+            );
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef ADRICONF_CONFIGURATIONVALIDATOR_H
+#define ADRICONF_CONFIGURATIONVALIDATOR_H
+
+#include <list>
+#include <glibmm/ustring.h>
+#include "Device.h"
+#include "DriverConfiguration.h"
+
+namespace ConfigurationValidator {
+    enum class Problem {
+        UNKNOWN_OPTION,
+        INVALID_TYPE,
+        OUT_OF_RANGE,
+        INVALID_ENUM_VALUE
+    };
+
+    /* A value that doesn't fit the driver schema */
+    struct Diagnostic {
+        Problem problem;
+        Glib::ustring driver;
+        int screen;
+        Glib::ustring application;
+        Glib::ustring option;
+        Glib::ustring value;
+        /* The type, range or enum values accepted by the driver */
+        Glib::ustring expected;
+    };
+
+    /**
+     * Check every option value of every application against the driver schema (type, range and enum values)
+     * The schema of each driver is compiled once and each device is checked in a single pass.
+     * Devices without a loaded driver are ignored, as they are handled by filterDriverUnsupportedOptions.
+     * @param driverAvailableOptions
+     * @param devices
+     * @return The list of invalid values, in document order
+     */
+    std::list<Diagnostic> validate(
+            const std::list<DriverConfiguration> &driverAvailableOptions,
+            const std::list<Device_ptr> &devices
+    );
+
+    /* Generate a human readable line describing the problem, suitable for logging */
+    Glib::ustring describe(const Diagnostic &diagnostic);
+};
+
+#endif
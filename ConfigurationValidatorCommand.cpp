@@ -0,0 +1,54 @@
+#include "CommandLine.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <glibmm/i18n.h>
+#include "ConfigurationLoader.h"
+#include "ConfigurationValidator.h"
+#include "Parser.h"
+
+int CommandLine::runValidate(int argc, char *argv[]) {
+    /* The user drirc is only needed when no file is given */
+    ConfigurationLoader configurationLoader;
+    Glib::ustring error;
+    auto configuration = configurationLoader.loadConcurrently(
+            HEADLESS_LOCALE,
+            ConfigurationLoader::DRIVERS | (argc <= 2 ? ConfigurationLoader::USER_DEFINED : 0),
+            &error
+    );
+    if (!error.empty()) {
+        std::cerr << Glib::ustring::compose(_("Couldn't parse the user configuration: %1"), error) << std::endl;
+        return 1;
+    }
+
+    auto &driverConfiguration = configuration.driverConfiguration;
+    auto &devices = configuration.userDefinedConfiguration;
+
+    for (int i = 2; i < argc; i++) {
+        std::ifstream input(argv[i]);
+        if (!input.good()) {
+            std::cerr << Glib::ustring::compose(_("Couldn't read file %1"), argv[i]) << std::endl;
+            return 1;
+        }
+
+        std::ostringstream buffer;
+        buffer << input.rdbuf();
+        Glib::ustring xml(buffer.str());
+
+        auto fileDevices = Parser::parseDevices(xml, &error);
+        if (!error.empty()) {
+            std::cerr << Glib::ustring::compose(_("Couldn't parse file %1: %2"), argv[i], error) << std::endl;
+            return 1;
+        }
+
+        devices.splice(devices.end(), fileDevices);
+    }
+
+    auto diagnostics = ConfigurationValidator::validate(driverConfiguration, devices);
+    for (const auto &diagnostic : diagnostics) {
+        std::cout << ConfigurationValidator::describe(diagnostic) << std::endl;
+    }
+
+    return diagnostics.empty() ? 0 : 2;
+}
@@ -0,0 +1,85 @@
+#include "Counters.h"
+
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+
+Counters::Slot Counters::slots[static_cast<std::size_t>(Counter::COUNT)] = {};
+
+namespace {
+    const char *COUNTER_NAMES[] = {
+            "xml_nodes_visited",
+            "resolver_comparisons",
+            "options_allocated",
+            "options_filtered",
+            "bytes_written"
+    };
+
+    static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == static_cast<std::size_t>(Counters::Counter::COUNT),
+                  "Every counter needs a name");
+
+    /* Only async-signal-safe calls: no allocation, no stdio */
+    void onReportSignal(int) {
+        char buffer[1024];
+        std::size_t length = 0;
+
+        for (std::size_t i = 0; i < static_cast<std::size_t>(Counters::Counter::COUNT); i++) {
+            auto nameLength = std::strlen(COUNTER_NAMES[i]);
+            if (length + nameLength + 23 > sizeof(buffer)) {
+                break;
+            }
+
+            std::memcpy(buffer + length, COUNTER_NAMES[i], nameLength);
+            length += nameLength;
+            buffer[length++] = '\t';
+
+            char digits[20];
+            std::size_t digitCount = 0;
+            uint64_t value = Counters::slots[i].value.load(std::memory_order_relaxed);
+            do {
+                digits[digitCount++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+
+            while (digitCount > 0) {
+                buffer[length++] = digits[--digitCount];
+            }
+            buffer[length++] = '\n';
+        }
+
+        auto written = write(STDERR_FILENO, buffer, length);
+        (void) written;
+    }
+}
+
+uint64_t Counters::get(Counter counter) {
+    return slots[static_cast<std::size_t>(counter)].value.load(std::memory_order_relaxed);
+}
+
+const char *Counters::getName(Counter counter) {
+    return COUNTER_NAMES[static_cast<std::size_t>(counter)];
+}
+
+std::string Counters::report() {
+    std::string output;
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(Counter::COUNT); i++) {
+        auto counter = static_cast<Counter>(i);
+        output.append(getName(counter));
+        output.append("\t");
+        output.append(std::to_string(get(counter)));
+        output.append("\n");
+    }
+
+    return output;
+}
+
+void Counters::installSignalHandler() {
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onReportSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    sigaction(SIGUSR1, &action, nullptr);
+}
@@ -0,0 +1,47 @@
+#ifndef ADRICONF_COUNTERS_H
+#define ADRICONF_COUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/* Size of a cache line, so counters updated by different threads don't share one */
+#define COUNTERS_CACHE_LINE 64
+
+/**
+ * Process-wide counters describing the shape of the work done, always compiled in
+ * Updates are relaxed atomic adds on their own cache line, and the hot loops count locally and add once,
+ * so leaving them on costs close to nothing.
+ */
+namespace Counters {
+    enum class Counter {
+        XML_NODES_VISITED,
+        RESOLVER_COMPARISONS,
+        OPTIONS_ALLOCATED,
+        OPTIONS_FILTERED,
+        BYTES_WRITTEN,
+        COUNT
+    };
+
+    struct alignas(COUNTERS_CACHE_LINE) Slot {
+        std::atomic<uint64_t> value;
+    };
+
+    extern Slot slots[static_cast<std::size_t>(Counter::COUNT)];
+
+    inline void add(Counter counter, uint64_t amount = 1) {
+        slots[static_cast<std::size_t>(counter)].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    uint64_t get(Counter counter);
+
+    const char *getName(Counter counter);
+
+    /* One "<name><TAB><value>" line per counter */
+    std::string report();
+
+    /* Print the report to the standard error on SIGUSR1, without stopping the process */
+    void installSignalHandler();
+};
+
+#endif
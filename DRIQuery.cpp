@@ -2,13 +2,19 @@
 #include <xf86drm.h>
 #include <iomanip>
 #include <fcntl.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <cstring>
+#include <algorithm>
+#include <map>
 #include <glibmm/i18n.h>
 
 #include "DRIQuery.h"
 #include "PCIDatabaseQuery.h"
+#include "PCIDriverMap.h"
 
 
-DRIQuery::DRIQuery() {
+DRIQuery::DRIQuery() : display(nullptr), sysfsRoot(SysfsEnumerator::getDefaultRoot()) {
     this->getScreenDriver = (glXGetScreenDriver_t *) glXGetProcAddress((const GLubyte *) "glXGetScreenDriver");
     this->getDriverConfig = (glXGetDriverConfig_t *) glXGetProcAddress((const GLubyte *) "glXGetDriverConfig");
     this->getRendererInfo = (glXQueryRenderer_t *) glXGetProcAddress((const GLubyte *) "glXQueryRendererIntegerMESA");
@@ -18,12 +24,40 @@ DRIQuery::DRIQuery() {
     }
 }
 
+void DRIQuery::setDisplay(Display *display) {
+    this->display = display;
+}
+
+void DRIQuery::setSysfsRoot(const std::string &sysfsRoot) {
+    this->sysfsRoot = sysfsRoot;
+}
+
 std::list<DriverConfiguration> DRIQuery::queryDriverConfigurationOptions(const Glib::ustring &locale) {
+    const char *alwaysSoftware = std::getenv("LIBGL_ALWAYS_SOFTWARE");
+    bool useSoftware = alwaysSoftware != nullptr && std::strcmp(alwaysSoftware, "0") != 0;
+
+    if (!useSoftware && (this->display != nullptr || std::getenv("DISPLAY") != nullptr)) {
+        auto configurations = this->queryDriverConfigurationOptionsGLX(locale);
+
+        if (!configurations.empty()) {
+            return configurations;
+        }
+    }
+
+    return this->queryDriverConfigurationOptionsDRI(locale);
+}
+
+std::list<DriverConfiguration> DRIQuery::queryDriverConfigurationOptionsGLX(const Glib::ustring &locale) {
     std::list<DriverConfiguration> configurations;
 
-    Display *display;
+    if (!this->getScreenDriver || !this->getDriverConfig || !this->getRendererInfo) {
+        return configurations;
+    }
+
+    /* Prefer the display already opened by the toolkit over a second connection */
+    Display *display = this->display;
 
-    if (!(display = XOpenDisplay(nullptr))) {
+    if (display == nullptr && !(display = XOpenDisplay(nullptr))) {
         std::cerr << _("Couldn't open X display") << std::endl;
         return configurations;
     }
@@ -32,6 +66,7 @@ std::list<DriverConfiguration> DRIQuery::queryDriverConfigurationOptions(const G
     glXGetClientString(display, GLX_EXTENSIONS);
 
     int screenCount = ScreenCount (display);
+    std::map<Glib::ustring, DriverSchema_ptr> schemas;
 
     for (int i = 0; i < screenCount; i++) {
         DriverConfiguration config;
@@ -45,63 +80,383 @@ std::list<DriverConfiguration> DRIQuery::queryDriverConfigurationOptions(const G
         config.setDeviceId(static_cast<uint16_t>(pciID));
 
         auto driverName = (*(this->getScreenDriver))(display, i);
+        if (driverName == nullptr) {
+            std::cerr << Glib::ustring::compose(_("Couldn't get the driver of screen %1"), i) << std::endl;
+            continue;
+        }
         config.setDriver(driverName);
 
-        auto driverOptions = (*(this->getDriverConfig))(driverName);
-        Glib::ustring options(driverOptions);
+        /* Screens using the same driver share its schema */
+        auto &schema = schemas[driverName];
+        if (schema == nullptr) {
+            auto driverOptions = (*(this->getDriverConfig))(driverName);
+            Glib::ustring options(driverOptions);
 
-        auto parsedSections = Parser::parseAvailableConfiguration(options, locale);
-        config.setSections(parsedSections);
+            schema = std::make_shared<const DriverSchema>(Parser::parseAvailableConfiguration(options, locale));
+        }
+        config.setSchema(schema);
 
         configurations.emplace_back(config);
     }
 
-    XCloseDisplay(display);
+    if (display != this->display) {
+        XCloseDisplay(display);
+    }
 
     return std::move(configurations);
 }
 
-std::map<Glib::ustring, GPUInfo_ptr> DRIQuery::enumerateDRIDevices() {
-    std::map<Glib::ustring, GPUInfo_ptr> gpus;
+std::list<DriverConfiguration> DRIQuery::queryDriverConfigurationOptionsDRI(const Glib::ustring &locale) {
+    std::list<DriverConfiguration> configurations;
 
-    PCIDatabaseQuery pciQuery;
+    /*
+     * Without X there are no screens, Mesa uses screen 0 for every device in this case.
+     * So each driver is listed only once.
+     */
+    std::vector<SysfsEnumerator::Card> cards;
+    std::list<std::pair<Glib::ustring, const SysfsEnumerator::Card *>> drivers;
+
+    const char *alwaysSoftware = std::getenv("LIBGL_ALWAYS_SOFTWARE");
+    if (alwaysSoftware != nullptr && std::strcmp(alwaysSoftware, "0") != 0) {
+        /* The software rasterizer (llvmpipe or softpipe) is built as the swrast DRI driver */
+        drivers.emplace_back("swrast", nullptr);
+    } else {
+        cards = this->enumerateCards();
+
+        for (const auto &card : cards) {
+            auto driverName = this->driverNameForCard(card);
+            if (driverName.empty()) {
+                continue;
+            }
+
+            auto alreadyListed = std::find_if(drivers.begin(), drivers.end(),
+                                              [&driverName](const std::pair<Glib::ustring, const SysfsEnumerator::Card *> &d) {
+                                                  return d.first == driverName;
+                                              });
+            if (alreadyListed == drivers.end()) {
+                drivers.emplace_back(driverName, &card);
+            }
+        }
+    }
+
+    for (const auto &driver : drivers) {
+        DriverConfiguration config;
+        if (this->queryCardConfiguration(driver.first, driver.second, locale, config)) {
+            configurations.emplace_back(config);
+        }
+    }
+
+    return configurations;
+}
+
+bool DRIQuery::queryDeviceConfiguration(
+        const Glib::ustring &busId,
+        const Glib::ustring &locale,
+        DriverConfiguration &configuration
+) {
+    for (const auto &card : this->enumerateCards()) {
+        if (card.busId != busId.raw()) {
+            continue;
+        }
+
+        auto driverName = this->driverNameForCard(card);
+        if (driverName.empty()) {
+            return false;
+        }
+
+        return this->queryCardConfiguration(driverName, &card, locale, configuration);
+    }
+
+    return false;
+}
+
+Glib::ustring DRIQuery::driverNameForCard(const SysfsEnumerator::Card &card) {
+    /* Display-only devices can't render, Mesa never loads a driver for them */
+    if (card.renderNode.empty()) {
+        return Glib::ustring();
+    }
+
+    const char *driverOverride = std::getenv("MESA_LOADER_DRIVER_OVERRIDE");
+    if (driverOverride != nullptr) {
+        return driverOverride;
+    }
+
+    /* Like Mesa's loader, the PCI id decides between the drivers sharing a kernel driver */
+    auto pciDriver = card.bus == "pci"
+                     ? PCIDriverMap::findDriver(card.driverName, card.vendorId, card.deviceId)
+                     : nullptr;
+    if (pciDriver != nullptr) {
+        if (this->driverIsInstalled(pciDriver)) {
+            return pciDriver;
+        }
+
+        std::cerr << Glib::ustring::compose(_("DRI driver '%1' isn't installed"), pciDriver) << std::endl;
+        return Glib::ustring();
+    }
+
+    for (const auto &possibleDriver : this->driverNamesForKernelDriver(card.driverName)) {
+        if (this->driverIsInstalled(possibleDriver)) {
+            return possibleDriver;
+        }
+    }
+
+    std::cerr << Glib::ustring::compose(_("No DRI driver found for kernel driver '%1'"), card.driverName)
+              << std::endl;
+
+    return Glib::ustring();
+}
+
+bool DRIQuery::queryCardConfiguration(
+        const Glib::ustring &driverName,
+        const SysfsEnumerator::Card *card,
+        const Glib::ustring &locale,
+        DriverConfiguration &configuration
+) {
+    auto options = this->queryDriverXML(driverName);
+    if (options.empty()) {
+        return false;
+    }
+
+    configuration.setScreen(0);
+    configuration.setDriver(driverName);
+    configuration.setVendorId(0);
+    configuration.setDeviceId(0);
+
+    /* The ids are only known for PCI devices, they stay 0 otherwise */
+    if (card != nullptr) {
+        configuration.setVendorId(card->vendorId);
+        configuration.setDeviceId(card->deviceId);
+    }
+
+    configuration.setSchema(std::make_shared<const DriverSchema>(Parser::parseAvailableConfiguration(options, locale)));
 
+    return true;
+}
+
+Glib::ustring DRIQuery::queryDriverXML(const Glib::ustring &driverName) {
+    Glib::ustring xml;
+    /* dlerror() is reset by each call and is NULL when nothing was tried */
+    Glib::ustring loadError(_("no driver search path"));
+
+    for (const auto &searchPath : this->driverSearchPaths()) {
+        Glib::ustring library(searchPath + "/" + driverName + "_dri.so");
+
+        /*
+         * The library is never closed, as drivers don't like being unloaded.
+         * It has the same lifetime as if glXGetDriverConfig had loaded it.
+         */
+        void *handle = dlopen(library.c_str(), RTLD_NOW | RTLD_GLOBAL);
+        if (handle == nullptr) {
+            const char *error = dlerror();
+            if (error != nullptr) {
+                loadError = error;
+            }
+            continue;
+        }
+
+        std::string symbolName("__driDriverGetExtensions_" + driverName.raw());
+        std::replace(symbolName.begin(), symbolName.end(), '-', '_');
+
+        const DRIExtension **extensions = nullptr;
+        auto getExtensions = (DRIDriverGetExtensions_t *) dlsym(handle, symbolName.c_str());
+        if (getExtensions != nullptr) {
+            extensions = getExtensions();
+        } else {
+            /* Older drivers only export the extension list */
+            extensions = (const DRIExtension **) dlsym(handle, "__driDriverExtensions");
+        }
+
+        for (int i = 0; extensions != nullptr && extensions[i] != nullptr; i++) {
+            if (std::strcmp(extensions[i]->name, DRI_CONFIG_OPTIONS_EXTENSION) != 0) {
+                continue;
+            }
+
+            auto configOptions = (const DRIConfigOptionsExtension *) extensions[i];
+
+            if (configOptions->base.version >= 2 && configOptions->getXml != nullptr) {
+                char *driverXml = configOptions->getXml(driverName.c_str());
+                if (driverXml != nullptr) {
+                    xml = driverXml;
+                    free(driverXml);
+                }
+            } else if (configOptions->xml != nullptr) {
+                xml = configOptions->xml;
+            }
+
+            break;
+        }
+
+        if (xml.empty()) {
+            std::cerr << Glib::ustring::compose(_("Driver '%1' doesn't expose its options"), library) << std::endl;
+        }
+
+        return xml;
+    }
+
+    std::cerr << Glib::ustring::compose(_("Couldn't load DRI driver '%1': %2"), driverName, loadError) << std::endl;
+
+    return xml;
+}
+
+std::list<Glib::ustring> DRIQuery::driverNamesForKernelDriver(const Glib::ustring &kernelDriver) {
+    /* Only used when the PCI id is unknown (see PCIDriverMap), the installed drivers are tried newest first */
+    if (kernelDriver == "i915") {
+        return {"iris", "crocus", "i965", "i915"};
+    }
+
+    if (kernelDriver == "xe") {
+        return {"iris"};
+    }
+
+    if (kernelDriver == "amdgpu") {
+        return {"radeonsi"};
+    }
+
+    if (kernelDriver == "radeon") {
+        return {"radeonsi", "r600", "r300"};
+    }
+
+    if (kernelDriver == "virtio_gpu") {
+        return {"virtio_gpu", "zink"};
+    }
+
+    /* Most of the drivers have the same name as the kernel driver (nouveau, vc4, etnaviv, msm...) */
+    return {kernelDriver};
+}
+
+bool DRIQuery::driverIsInstalled(const Glib::ustring &driverName) {
+    for (const auto &searchPath : this->driverSearchPaths()) {
+        Glib::ustring library(searchPath + "/" + driverName + "_dri.so");
+
+        if (access(library.c_str(), R_OK) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::list<Glib::ustring> DRIQuery::driverSearchPaths() {
+    std::list<Glib::ustring> searchPaths;
+
+    /* Same variable used by Mesa to load the drivers from a different place */
+    const char *driversPath = std::getenv("LIBGL_DRIVERS_PATH");
+    if (driversPath == nullptr) {
+        searchPaths.emplace_back(DRI_DRIVERS_DIR);
+        return searchPaths;
+    }
+
+    std::string paths(driversPath);
+    std::size_t start = 0;
+    while (start <= paths.length()) {
+        auto end = paths.find(':', start);
+        if (end == std::string::npos) {
+            end = paths.length();
+        }
+
+        if (end > start) {
+            searchPaths.emplace_back(paths.substr(start, end - start));
+        }
+
+        start = end + 1;
+    }
+
+    return searchPaths;
+}
+
+std::vector<SysfsEnumerator::Card> DRIQuery::enumerateCards() {
+    auto cards = SysfsEnumerator::enumerate(this->sysfsRoot);
+    if (!cards.empty()) {
+        return cards;
+    }
+
+    /* Without sysfs (some containers) ask libdrm, which has to open the nodes to learn the kernel driver */
     drmDevicePtr enumeratedDevices[MESA_MAX_DRM_DEVICES];
     int deviceCount = drmGetDevices2(0, enumeratedDevices, MESA_MAX_DRM_DEVICES);
 
     for (int i = 0; i < deviceCount; i++) {
-        GPUInfo_ptr gpu = std::make_shared<GPUInfo>();
+        const auto device = enumeratedDevices[i];
+        const char *nodePath = nullptr;
+
+        SysfsEnumerator::Card card;
+        card.vendorId = 0;
+        card.deviceId = 0;
+
+        if (device->available_nodes & (1 << DRM_NODE_PRIMARY)) {
+            card.name = Glib::path_get_basename(device->nodes[DRM_NODE_PRIMARY]);
+            nodePath = device->nodes[DRM_NODE_PRIMARY];
+        }
+
+        if (device->available_nodes & (1 << DRM_NODE_RENDER)) {
+            card.renderNode = Glib::path_get_basename(device->nodes[DRM_NODE_RENDER]);
+            nodePath = device->nodes[DRM_NODE_RENDER];
+        }
+
+        if (nodePath == nullptr) {
+            continue;
+        }
+
+        int fd = open(nodePath, O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            drmVersionPtr versionPtr = drmGetVersion(fd);
+            if (versionPtr != nullptr) {
+                card.driverName = versionPtr->name;
+                drmFreeVersion(versionPtr);
+            }
+            close(fd);
+        }
+
+        if (device->bustype == DRM_BUS_PCI && device->businfo.pci != nullptr) {
+            card.bus = "pci";
+            card.busId = Glib::ustring::compose(
+                    "pci-%1_%2_%3_%4",
+                    Glib::ustring::format(std::setfill(L'0'), std::setw(4), std::hex, device->businfo.pci->domain),
+                    Glib::ustring::format(std::setfill(L'0'), std::setw(2), std::hex, device->businfo.pci->bus),
+                    Glib::ustring::format(std::setfill(L'0'), std::setw(2), std::hex, device->businfo.pci->dev),
+                    device->businfo.pci->func
+            );
+
+            if (device->deviceinfo.pci != nullptr) {
+                card.vendorId = device->deviceinfo.pci->vendor_id;
+                card.deviceId = device->deviceinfo.pci->device_id;
+            }
+        } else {
+            /* Platform, USB and host1x devices are told apart by their node */
+            card.bus = device->bustype == DRM_BUS_PLATFORM ? "platform" : "drm";
+            card.busId = card.bus + "-" + Glib::path_get_basename(nodePath);
+        }
+
+        cards.emplace_back(card);
+    }
 
-        gpu->setPciId(Glib::ustring::compose(
-                "pci-%1_%2_%3_%4",
-                Glib::ustring::format(std::setfill(L'0'), std::setw(4), std::hex,
-                                      enumeratedDevices[i]->businfo.pci->domain),
-                Glib::ustring::format(std::setfill(L'0'), std::setw(2), std::hex,
-                                      enumeratedDevices[i]->businfo.pci->bus),
-                Glib::ustring::format(std::setfill(L'0'), std::setw(2), std::hex,
-                                      enumeratedDevices[i]->businfo.pci->dev),
-                enumeratedDevices[i]->businfo.pci->func
-        ));
+    if (deviceCount > 0) {
+        drmFreeDevices(enumeratedDevices, deviceCount);
+    }
 
-        int fd = open(enumeratedDevices[i]->nodes[DRM_NODE_RENDER], O_RDONLY);
-        drmVersionPtr versionPtr = drmGetVersion(fd);
+    return cards;
+}
 
-        gpu->setDriverName(versionPtr->name);
+std::map<Glib::ustring, GPUInfo_ptr> DRIQuery::enumerateDRIDevices() {
+    std::map<Glib::ustring, GPUInfo_ptr> gpus;
 
-        drmFreeVersion(versionPtr);
-        close(fd);
+    PCIDatabaseQuery pciQuery;
+
+    for (const auto &card : this->enumerateCards()) {
+        GPUInfo_ptr gpu = std::make_shared<GPUInfo>();
 
-        gpu->setVendorId(enumeratedDevices[i]->deviceinfo.pci->vendor_id);
-        gpu->setDeviceId(enumeratedDevices[i]->deviceinfo.pci->device_id);
+        gpu->setPciId(card.busId);
+        gpu->setDriverName(card.driverName);
+        gpu->setVendorId(card.vendorId);
+        gpu->setDeviceId(card.deviceId);
 
-        gpu->setVendorName(pciQuery.queryVendorName(gpu->getVendorId()));
-        gpu->setDeviceName(pciQuery.queryDeviceName(gpu->getVendorId(), gpu->getDeviceId()));
+        /* Only PCI devices are in the database */
+        if (card.bus == "pci") {
+            gpu->setVendorName(pciQuery.queryVendorName(gpu->getVendorId()));
+            gpu->setDeviceName(pciQuery.queryDeviceName(gpu->getVendorId(), gpu->getDeviceId()));
+        }
 
         gpus[gpu->getPciId()] = gpu;
     }
 
-    drmFreeDevices(enumeratedDevices, deviceCount);
-
     return gpus;
 }
-
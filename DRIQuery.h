@@ -8,11 +8,34 @@
 #include <GL/glxext.h>
 #include <X11/Xlib.h>
 #include <glibmm/ustring.h>
+#include <map>
 #include "GPUInfo.h"
+#include "SysfsEnumerator.h"
 
 /* MESA HAS THIS HARD-CODED SO WE MUST HARD-CODE IT ALSO */
 #define MESA_MAX_DRM_DEVICES 32
 
+/* Mesa loader interface, copied as GL/internal/dri_interface.h is not installed everywhere */
+#define DRI_CONFIG_OPTIONS_EXTENSION "DRI_ConfigOptions"
+
+#ifndef DRI_DRIVERS_DIR
+#define DRI_DRIVERS_DIR "/usr/lib/dri"
+#endif
+
+typedef struct {
+    const char *name;
+    int version;
+} DRIExtension;
+
+typedef struct {
+    DRIExtension base;
+    const char *xml;
+
+    char *(*getXml)(const char *driverName);
+} DRIConfigOptionsExtension;
+
+typedef const DRIExtension **DRIDriverGetExtensions_t();
+
 typedef const char *glXGetScreenDriver_t(Display *dpy, int scrNum);
 
 typedef const char *glXGetDriverConfig_t(const char *driverName);
@@ -24,13 +47,66 @@ private:
     glXGetScreenDriver_t *getScreenDriver;
     glXGetDriverConfig_t *getDriverConfig;
     glXQueryRenderer_t *getRendererInfo;
+    Display *display;
+    std::string sysfsRoot;
+
+    /* Load the DRI driver library and ask it directly for the options XML */
+    Glib::ustring queryDriverXML(const Glib::ustring &driverName);
+
+    /* Possible DRI drivers for a kernel driver when the PCI id doesn't tell, the first one installed is used */
+    std::list<Glib::ustring> driverNamesForKernelDriver(const Glib::ustring &kernelDriver);
+
+    bool driverIsInstalled(const Glib::ustring &driverName);
+
+    std::list<Glib::ustring> driverSearchPaths();
+
+    /* From sysfs, falling back to libdrm when sysfs has no DRM device */
+    std::vector<SysfsEnumerator::Card> enumerateCards();
+
+    /* The DRI driver Mesa loads for the card, empty if it has no render node or no driver is installed */
+    Glib::ustring driverNameForCard(const SysfsEnumerator::Card &card);
+
+    /* @param card The device the driver is loaded for, nullptr for the software rasterizer */
+    bool queryCardConfiguration(
+            const Glib::ustring &driverName,
+            const SysfsEnumerator::Card *card,
+            const Glib::ustring &locale,
+            DriverConfiguration &configuration
+    );
 
 public:
     DRIQuery();
 
+    /* Use an already opened X display instead of opening a new connection */
+    void setDisplay(Display *display);
+
+    /* Read the devices from another sysfs tree, see SysfsEnumerator */
+    void setSysfsRoot(const std::string &sysfsRoot);
+
+    /**
+     * Query the options of each driver
+     * Uses GLX when an X display is available, otherwise loads the DRI drivers of the render nodes directly.
+     * When LIBGL_ALWAYS_SOFTWARE is set, the software rasterizer is queried instead of the hardware.
+     */
     std::list<DriverConfiguration> queryDriverConfigurationOptions(const Glib::ustring &locale);
 
+    std::list<DriverConfiguration> queryDriverConfigurationOptionsGLX(const Glib::ustring &locale);
+
+    std::list<DriverConfiguration> queryDriverConfigurationOptionsDRI(const Glib::ustring &locale);
+
+    /**
+     * Query the options of the driver of a single device, as the DRI path does (screen 0)
+     * @param busId The key of the device in enumerateDRIDevices()
+     * @return false if the device is gone, can't render or its driver isn't installed
+     */
+    bool queryDeviceConfiguration(
+            const Glib::ustring &busId,
+            const Glib::ustring &locale,
+            DriverConfiguration &configuration
+    );
+
+    /* Keyed by bus id, like pci-0000_01_00_0. No device node is opened unless sysfs is missing */
     std::map<Glib::ustring, GPUInfo_ptr> enumerateDRIDevices();
 };
 
-#endif
\ No newline at end of file
+#endif
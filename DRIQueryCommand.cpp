@@ -0,0 +1,34 @@
+#include "CommandLine.h"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "DRIQuery.h"
+
+int CommandLine::runGPUs(int argc, char *argv[]) {
+    DRIQuery driQuery;
+
+    for (int i = 2; i < argc; i++) {
+        std::string argument(argv[i]);
+
+        if (argument == "--sysfs-root" && i + 1 < argc) {
+            driQuery.setSysfsRoot(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    /* One "<bus id><TAB><kernel driver><TAB><vendor id><TAB><device id><TAB><vendor><TAB><device>" line each */
+    for (const auto &gpu : driQuery.enumerateDRIDevices()) {
+        std::cout << gpu.first
+                  << "\t" << gpu.second->getDriverName()
+                  << "\t" << Glib::ustring::format(std::setfill(L'0'), std::setw(4), std::hex, gpu.second->getVendorId())
+                  << "\t" << Glib::ustring::format(std::setfill(L'0'), std::setw(4), std::hex, gpu.second->getDeviceId())
+                  << "\t" << gpu.second->getVendorName()
+                  << "\t" << gpu.second->getDeviceName()
+                  << std::endl;
+    }
+
+    return 0;
+}
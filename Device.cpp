@@ -18,23 +18,82 @@ void Device::setScreen(int screen) {
     this->screen = screen;
 }
 
-std::list<Application_ptr> &Device::getApplications() {
-    return this->applications;
-}
-
 const std::list<Application_ptr> &Device::getApplications() const {
     return this->applications;
 }
 
 void Device::addApplication(Application_ptr application) {
-    this->applications.emplace_back(application);
+    this->applicationIndex[application->getMatchRulesHash()].emplace_back(application);
+    this->applications.emplace_back(std::move(application));
+}
+
+void Device::insertApplication(Application_ptr application) {
+    auto position = std::find_if(this->applications.begin(), this->applications.end(),
+                                 [&application](const Application_ptr &a) {
+                                     return application->getName() < a->getName();
+                                 });
+
+    auto &bucket = this->applicationIndex[application->getMatchRulesHash()];
+    this->applications.insert(position, application);
+
+    /* Appending to the bucket only keeps the list order when the application lands after its equivalents */
+    if (bucket.empty() || position == this->applications.end()) {
+        bucket.emplace_back(std::move(application));
+    } else {
+        this->rebuildApplicationIndex();
+    }
+}
+
+void Device::removeApplication(const Application_ptr &application) {
+    auto bucket = this->applicationIndex.find(application->getMatchRulesHash());
+    if (bucket == this->applicationIndex.end()) {
+        return;
+    }
+
+    auto &candidates = bucket->second;
+    candidates.erase(std::remove(candidates.begin(), candidates.end(), application), candidates.end());
+    if (candidates.empty()) {
+        this->applicationIndex.erase(bucket);
+    }
+
+    this->applications.remove(application);
+}
+
+void Device::replaceApplication(const Application_ptr &oldApplication, Application_ptr newApplication) {
+    if (newApplication->getMatchRulesHash() != oldApplication->getMatchRulesHash()) {
+        std::replace(this->applications.begin(), this->applications.end(), oldApplication, newApplication);
+        this->rebuildApplicationIndex();
+        return;
+    }
+
+    auto bucket = this->applicationIndex.find(oldApplication->getMatchRulesHash());
+    if (bucket == this->applicationIndex.end()) {
+        return;
+    }
+
+    std::replace(bucket->second.begin(), bucket->second.end(), oldApplication, newApplication);
+    std::replace(this->applications.begin(), this->applications.end(), oldApplication, newApplication);
+}
+
+void Device::rebuildApplicationIndex() {
+    this->applicationIndex.clear();
+
+    for (const auto &application : this->applications) {
+        this->applicationIndex[application->getMatchRulesHash()].emplace_back(application);
+    }
 }
 
-Device::Device() : driver(""), screen(-1), applications() {}
+Device::Device() : driver(""), screen(-1), applications(), applicationIndex() {}
 
-Application_ptr Device::findApplication(const Glib::ustring &executable) const {
-    for (auto app : this->applications) {
-        if (app->getExecutable() == executable) {
+Application_ptr Device::findEquivalentApplication(const Application &application) const {
+    auto bucket = this->applicationIndex.find(application.getMatchRulesHash());
+    if (bucket == this->applicationIndex.end()) {
+        return nullptr;
+    }
+
+    /* Different matching rules may share a hash */
+    for (const auto &app : bucket->second) {
+        if (app->hasSameMatchRules(application)) {
             return app;
         }
     }
@@ -42,8 +101,35 @@ Application_ptr Device::findApplication(const Glib::ustring &executable) const {
     return nullptr;
 }
 
+bool Device::hasApplication(const Application_ptr &application) const {
+    auto bucket = this->applicationIndex.find(application->getMatchRulesHash());
+
+    return bucket != this->applicationIndex.end()
+           && std::find(bucket->second.begin(), bucket->second.end(), application) != bucket->second.end();
+}
+
 void Device::sortApplications() {
-    this->applications.sort([](Application_ptr a, Application_ptr b) {
+    this->sortApplications([](const Application_ptr &a, const Application_ptr &b) {
         return a->getName() < b->getName();
     });
-}
\ No newline at end of file
+}
+
+void Device::sortApplications(
+        const std::function<bool(const Application_ptr &, const Application_ptr &)> &compare
+) {
+    this->applications.sort(compare);
+
+    /* Equivalent applications may have changed order */
+    this->rebuildApplicationIndex();
+}
+
+std::size_t Device::getIndexBytes() const {
+    /* A node holds the key, the bucket and a next pointer, plus the array of bucket heads */
+    std::size_t bytes = this->applicationIndex.bucket_count() * sizeof(void *);
+
+    for (const auto &bucket : this->applicationIndex) {
+        bytes += sizeof(void *) + sizeof(bucket) + bucket.second.capacity() * sizeof(Application_ptr);
+    }
+
+    return bytes;
+}
@@ -1,16 +1,30 @@
 #ifndef DRICONF3_DEVICE_H
 #define DRICONF3_DEVICE_H
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <list>
+#include <unordered_map>
+#include <vector>
 #include <glibmm/ustring.h>
 #include "Application.h"
 
+/**
+ * The applications of a driver/screen pair
+ * The applications are indexed by the hash of their matching rules, so finding the equivalent application
+ * doesn't scan the list. The list is only changed through the methods below, which keep the index in sync,
+ * and the matching rules of an application must not change once it is added (copy it instead).
+ */
 class Device {
 private:
     Glib::ustring driver;
     int screen;
     std::list<Application_ptr> applications;
+    /* Applications with the same matching rules hash, in list order */
+    std::unordered_map<std::size_t, std::vector<Application_ptr>> applicationIndex;
+
+    void rebuildApplicationIndex();
 
 public:
     const Glib::ustring &getDriver() const;
@@ -21,16 +35,29 @@ public:
 
     void setScreen(int screen);
 
-    std::list<Application_ptr> &getApplications();
-
     const std::list<Application_ptr> &getApplications() const;
 
     void addApplication(Application_ptr application);
 
-    Application_ptr findApplication(const Glib::ustring &executable) const;
+    /* Insert before the first application with a greater name, so a sorted list stays sorted */
+    void insertApplication(Application_ptr application);
+
+    void removeApplication(const Application_ptr &application);
+
+    void replaceApplication(const Application_ptr &oldApplication, Application_ptr newApplication);
+
+    /* Find the application that has the same matching rules as the given one */
+    Application_ptr findEquivalentApplication(const Application &application) const;
+
+    bool hasApplication(const Application_ptr &application) const;
 
     void sortApplications();
 
+    void sortApplications(const std::function<bool(const Application_ptr &, const Application_ptr &)> &compare);
+
+    /* Heap memory used by the application index */
+    std::size_t getIndexBytes() const;
+
     Device();
 };
 
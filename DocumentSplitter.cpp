@@ -0,0 +1,271 @@
+#include "DocumentSplitter.h"
+
+#include <cstring>
+#include <utility>
+
+namespace {
+    bool isWhitespace(char character) {
+        return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+    }
+
+    bool isNameEnd(char character) {
+        return isWhitespace(character) || character == '/' || character == '>';
+    }
+
+    /* Wraps the pieces of the document so each one is a complete document */
+    class ChunkWriter {
+    private:
+        const std::string &xml;
+        std::size_t targetBytes;
+        std::vector<DocumentSplitter::Chunk> &chunks;
+        std::string prefix;
+        std::string suffix;
+
+        void addChunk(const std::string &content, bool continuation) {
+            DocumentSplitter::Chunk chunk;
+            chunk.xml.reserve(this->prefix.size() + content.size() + this->suffix.size());
+            chunk.xml.append(this->prefix).append(content).append(this->suffix);
+            chunk.continuation = continuation;
+
+            this->chunks.emplace_back(std::move(chunk));
+        }
+
+    public:
+        ChunkWriter(const std::string &xml, std::size_t targetBytes, std::vector<DocumentSplitter::Chunk> &chunks)
+                : xml(xml), targetBytes(targetBytes), chunks(chunks) {}
+
+        void setRoot(const std::string &declaration, const std::string &rootStartTag, const std::string &rootName) {
+            this->prefix = declaration + rootStartTag;
+            this->suffix = "</" + rootName + ">";
+        }
+
+        /**
+         * @param start Where the device start tag begins
+         * @param startTagEnd Right after the device start tag
+         * @param endTagStart Where the device end tag begins
+         * @param end Right after the device end tag
+         * @param childEnds Right after each child element of the device
+         */
+        void addDevice(
+                std::size_t start,
+                std::size_t startTagEnd,
+                std::size_t endTagStart,
+                std::size_t end,
+                const std::vector<std::size_t> &childEnds
+        ) {
+            if (end - start <= this->targetBytes || childEnds.size() < 2) {
+                this->addChunk(this->xml.substr(start, end - start), false);
+                return;
+            }
+
+            /* Big devices are cut between their applications, every piece repeating the device start tag */
+            std::string startTag(this->xml, start, startTagEnd - start);
+            std::size_t pieceStart = startTagEnd;
+            bool continuation = false;
+
+            for (auto childEnd : childEnds) {
+                if (childEnd - pieceStart < this->targetBytes || childEnd == childEnds.back()) {
+                    continue;
+                }
+
+                this->addChunk(startTag + this->xml.substr(pieceStart, childEnd - pieceStart) + "</device>",
+                               continuation);
+                pieceStart = childEnd;
+                continuation = true;
+            }
+
+            this->addChunk(startTag + this->xml.substr(pieceStart, endTagStart - pieceStart) + "</device>",
+                           continuation);
+        }
+    };
+}
+
+bool DocumentSplitter::split(const std::string &xml, std::size_t targetBytes, std::vector<Chunk> &chunks) {
+    chunks.clear();
+
+    const char *data = xml.data();
+    std::size_t length = xml.size();
+    std::size_t position = 0;
+
+    /* Byte order mark */
+    if (xml.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        position = 3;
+    }
+
+    std::string declaration;
+    if (xml.compare(position, 5, "<?xml") == 0) {
+        auto end = xml.find("?>", position);
+        if (end == std::string::npos) {
+            return false;
+        }
+
+        declaration = xml.substr(position, end + 2 - position);
+        position = end + 2;
+    }
+
+    ChunkWriter writer(xml, targetBytes, chunks);
+    /* Offset and length of the name of each open element */
+    std::vector<std::pair<std::size_t, std::size_t>> openElements;
+    bool rootClosed = false;
+
+    bool inDevice = false;
+    std::size_t deviceStart = 0;
+    std::size_t deviceStartTagEnd = 0;
+    std::vector<std::size_t> childEnds;
+
+    while (position < length) {
+        auto markup = xml.find('<', position);
+        if (markup == std::string::npos) {
+            markup = length;
+        }
+
+        /* Only whitespace outside the root, and no entity outside the devices as it may be undefined */
+        if (!inDevice) {
+            for (auto i = position; i < markup; i++) {
+                if (data[i] == '&' || (openElements.empty() && !isWhitespace(data[i]))) {
+                    return false;
+                }
+            }
+        }
+
+        if (markup == length) {
+            break;
+        }
+
+        char markupType = markup + 1 < length ? data[markup + 1] : '\0';
+
+        if (markupType == '!' && xml.compare(markup, 4, "<!--") == 0) {
+            /* "--" is only allowed to close the comment */
+            auto end = xml.find("--", markup + 4);
+            if (end == std::string::npos || xml.compare(end, 3, "-->") != 0) {
+                return false;
+            }
+
+            position = end + 3;
+            continue;
+        }
+
+        if (markupType == '!' && xml.compare(markup, 9, "<![CDATA[") == 0) {
+            auto end = xml.find("]]>", markup + 9);
+            if (end == std::string::npos || openElements.empty()) {
+                return false;
+            }
+
+            position = end + 3;
+            continue;
+        }
+
+        if (markupType == '?') {
+            auto end = xml.find("?>", markup + 2);
+            if (end == std::string::npos) {
+                return false;
+            }
+
+            position = end + 2;
+            continue;
+        }
+
+        /* A DOCTYPE may declare entities and default attributes for the whole document */
+        if (markupType == '!') {
+            return false;
+        }
+
+        bool endTag = markupType == '/';
+        std::size_t nameStart = markup + (endTag ? 2 : 1);
+        std::size_t nameEnd = nameStart;
+        while (nameEnd < length && !isNameEnd(data[nameEnd])) {
+            if (data[nameEnd] == '<' || data[nameEnd] == '"' || data[nameEnd] == '\'') {
+                return false;
+            }
+            nameEnd++;
+        }
+
+        if (nameEnd == nameStart) {
+            return false;
+        }
+
+        /* '>' is allowed inside attribute values, '<' isn't. Values are skipped with memchr, which is vectorized */
+        std::size_t tagEnd = nameEnd;
+        while (tagEnd < length && data[tagEnd] != '>') {
+            char character = data[tagEnd];
+
+            if (character == '<') {
+                return false;
+            }
+
+            if (character == '"' || character == '\'') {
+                auto valueStart = data + tagEnd + 1;
+                auto valueEnd = static_cast<const char *>(std::memchr(valueStart, character, length - tagEnd - 1));
+                if (valueEnd == nullptr || std::memchr(valueStart, '<', valueEnd - valueStart) != nullptr) {
+                    return false;
+                }
+
+                tagEnd = valueEnd - data;
+            }
+
+            tagEnd++;
+        }
+
+        if (tagEnd == length) {
+            return false;
+        }
+
+        position = tagEnd + 1;
+        std::size_t nameLength = nameEnd - nameStart;
+
+        if (endTag) {
+            if (openElements.empty() || openElements.back().second != nameLength
+                || xml.compare(openElements.back().first, nameLength, xml, nameStart, nameLength) != 0) {
+                return false;
+            }
+
+            openElements.pop_back();
+
+            if (inDevice && openElements.size() == 2) {
+                childEnds.emplace_back(position);
+            } else if (inDevice && openElements.size() == 1) {
+                writer.addDevice(deviceStart, deviceStartTagEnd, markup, position, childEnds);
+                inDevice = false;
+            } else if (openElements.empty()) {
+                rootClosed = true;
+            }
+
+            continue;
+        }
+
+        bool selfClosing = data[tagEnd - 1] == '/';
+        std::size_t depth = openElements.size();
+
+        if (depth == 0) {
+            /* A second root element, or an empty one with nothing to split */
+            if (rootClosed || selfClosing) {
+                return false;
+            }
+
+            writer.setRoot(declaration, xml.substr(markup, position - markup), xml.substr(nameStart, nameLength));
+        }
+
+        bool device = depth == 1 && xml.compare(nameStart, nameLength, "device") == 0;
+
+        if (selfClosing) {
+            if (device) {
+                writer.addDevice(markup, position, position, position, std::vector<std::size_t>());
+            } else if (inDevice && depth == 2) {
+                childEnds.emplace_back(position);
+            }
+
+            continue;
+        }
+
+        if (device) {
+            inDevice = true;
+            deviceStart = markup;
+            deviceStartTagEnd = position;
+            childEnds.clear();
+        }
+
+        openElements.emplace_back(nameStart, nameLength);
+    }
+
+    return rootClosed && openElements.empty();
+}
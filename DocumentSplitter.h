@@ -0,0 +1,34 @@
+#ifndef ADRICONF_DOCUMENTSPLITTER_H
+#define ADRICONF_DOCUMENTSPLITTER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Cut a drirc document into small documents that can be parsed independently
+ * A quick scan of the markup finds every <device> child of the root element, and devices bigger than
+ * the target size are cut between their applications. Each chunk keeps the XML declaration, the root
+ * start tag and (for the pieces of a device) the device start tag, so parsing it gives the same values.
+ *
+ * The scan refuses anything it can't prove to be equivalent (a DOCTYPE, which may declare entities or
+ * default attributes, entities outside the devices, unbalanced tags...), in which case the whole
+ * document must be parsed at once.
+ */
+namespace DocumentSplitter {
+    struct Chunk {
+        std::string xml;
+        /* The applications continue the device of the previous chunk */
+        bool continuation;
+    };
+
+    /**
+     * @param xml
+     * @param targetBytes Devices bigger than this are cut in pieces of about this size
+     * @param chunks Receives the chunks, in document order
+     * @return false if the document can't be split safely
+     */
+    bool split(const std::string &xml, std::size_t targetBytes, std::vector<Chunk> &chunks);
+};
+
+#endif
@@ -16,48 +16,43 @@ void DriverConfiguration::setScreen(int screen) {
     DriverConfiguration::screen = screen;
 }
 
-const std::list<Section> &DriverConfiguration::getSections() const {
-    return sections;
+const DriverSchema_ptr &DriverConfiguration::getSchema() const {
+    return schema;
 }
 
-void DriverConfiguration::setSections(const std::list<Section> &sections) {
-    this->sections = sections;
+void DriverConfiguration::setSchema(DriverSchema_ptr schema) {
+    DriverConfiguration::schema = std::move(schema);
 }
 
-std::list<std::pair<Glib::ustring, Glib::ustring>>
-DriverConfiguration::getEnumValuesForOption(const Glib::ustring &optionName) {
-    for (const auto &section : this->sections) {
-        for (const auto &option : section.getOptions()) {
-            if (option.getName() == optionName) {
-                return option.getEnumValues();
-            }
-        }
+const std::list<Section> &DriverConfiguration::getSections() const {
+    static const std::list<Section> noSections;
+
+    if (this->schema == nullptr) {
+        return noSections;
     }
-}
 
-Application_ptr DriverConfiguration::generateApplication() const {
-    Application_ptr app = std::make_shared<Application>();
-    std::list<ApplicationOption_ptr> options;
+    return this->schema->getSections();
+}
 
-    for (const auto &section : this->sections) {
-        for (const auto &option : section.getOptions()) {
-            auto driverOpt = std::make_shared<ApplicationOption>();
-            driverOpt->setName(option.getName());
-            driverOpt->setValue(option.getDefaultValue());
+const std::list<std::pair<Glib::ustring, Glib::ustring>> &
+DriverConfiguration::getEnumValuesForOption(const Glib::ustring &optionName) const {
+    static const std::list<std::pair<Glib::ustring, Glib::ustring>> noEnumValues;
 
-            options.emplace_back(driverOpt);
-        }
+    if (this->schema == nullptr) {
+        return noEnumValues;
     }
 
-    app->setOptions(options);
+    auto option = this->schema->findOption(optionName);
+    if (option == nullptr) {
+        return noEnumValues;
+    }
 
-    return app;
+    return option->getEnumValues();
 }
 
-void DriverConfiguration::sortSectionOptions() {
-    for (auto &section : this->sections) {
-        section.sortOptions();
-    }
+Application_ptr DriverConfiguration::generateApplication() const {
+    /* Applications only store overrides, the driver defaults are resolved when displayed */
+    return std::make_shared<Application>();
 }
 
 uint16_t DriverConfiguration::getVendorId() const {
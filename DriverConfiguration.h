@@ -4,13 +4,13 @@
 #include <list>
 #include <glibmm/ustring.h>
 #include "Application.h"
-#include "Section.h"
+#include "DriverSchema.h"
 
 class DriverConfiguration {
 private:
     Glib::ustring driver;
     int screen;
-    std::list<Section> sections;
+    DriverSchema_ptr schema;
     uint16_t vendorId;
     uint16_t deviceId;
 
@@ -23,11 +23,13 @@ public:
 
     void setScreen(int screen);
 
-    const std::list<Section> &getSections() const;
+    const DriverSchema_ptr &getSchema() const;
+
+    void setSchema(DriverSchema_ptr schema);
 
-    void setSections(const std::list<Section> &sections);
+    const std::list<Section> &getSections() const;
 
-    std::list<std::pair<Glib::ustring, Glib::ustring>> getEnumValuesForOption(const Glib::ustring &);
+    const std::list<std::pair<Glib::ustring, Glib::ustring>> &getEnumValuesForOption(const Glib::ustring &) const;
 
     uint16_t getVendorId() const;
 
@@ -37,11 +39,8 @@ public:
 
     void setDeviceId(uint16_t deviceId);
 
-    /* Generate a new application based on this driver-supported options */
+    /* Generate a new application for this driver, without any option overridden */
     Application_ptr generateApplication() const;
-
-    /* Sort the options inside each section to be more user-friendly */
-    void sortSectionOptions();
 };
 
 #endif
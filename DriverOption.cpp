@@ -27,7 +27,7 @@ const Glib::ustring &DriverOption::getValidValues() const {
     return this->validValues;
 }
 
-std::list<std::pair<Glib::ustring, Glib::ustring>> DriverOption::getEnumValues() const {
+const std::list<std::pair<Glib::ustring, Glib::ustring>> &DriverOption::getEnumValues() const {
     return this->enumValues;
 }
 
@@ -33,7 +33,7 @@ public:
 
     bool isFakeBool() const;
 
-    std::list<std::pair<Glib::ustring, Glib::ustring>> getEnumValues() const;
+    const std::list<std::pair<Glib::ustring, Glib::ustring>> &getEnumValues() const;
 
     DriverOption *setName(Glib::ustring name);
 
@@ -0,0 +1,159 @@
+#include "DriverSchema.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+    /* Seeds tried for a bucket before the table is made bigger */
+    const uint32_t MAX_BUCKET_SEED = 1u << 16;
+
+    std::size_t nextPowerOfTwo(std::size_t value) {
+        std::size_t power = 1;
+        while (power < value) {
+            power <<= 1;
+        }
+
+        return power;
+    }
+}
+
+DriverSchema::DriverSchema(std::list<Section> sections) : sections(std::move(sections)) {
+    for (auto &section : this->sections) {
+        section.sortOptions();
+
+        for (const auto &option : section.getOptions()) {
+            this->options.emplace_back(&option);
+        }
+    }
+
+    /* About four names per bucket and a table a bit bigger than the options always converge quickly */
+    std::size_t bucketCount = nextPowerOfTwo(std::max<std::size_t>(this->options.size() / 4, 1));
+    std::size_t slotCount = nextPowerOfTwo(this->options.size() + this->options.size() / 4 + 1);
+
+    /* Very unlucky names may need a sparser table */
+    while (!this->buildIndex(bucketCount, slotCount)) {
+        slotCount <<= 1;
+    }
+}
+
+uint64_t DriverSchema::getSlotHash(uint64_t nameHash, uint32_t seed) {
+    /* Reseeding only remixes the name hash, so each name is read once per lookup */
+    uint64_t value = nameHash ^ (seed * 0x9e3779b97f4a7c15ULL);
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+
+    return value;
+}
+
+bool DriverSchema::buildIndex(std::size_t bucketCount, std::size_t slotCount) {
+    this->bucketSeeds.assign(bucketCount, 0);
+    this->slotOrdinals.assign(slotCount, DRIVER_SCHEMA_NO_ORDINAL);
+
+    std::vector<std::vector<std::size_t>> buckets(bucketCount);
+    for (std::size_t ordinal = 0; ordinal < this->options.size(); ordinal++) {
+        const auto &name = this->options[ordinal]->getName().raw();
+        auto &bucket = buckets[std::hash<std::string>()(name) & (bucketCount - 1)];
+
+        /* A name given twice resolves to its last option */
+        auto duplicate = std::find_if(bucket.begin(), bucket.end(), [this, &name](std::size_t other) {
+            return this->options[other]->getName().raw() == name;
+        });
+
+        if (duplicate != bucket.end()) {
+            *duplicate = ordinal;
+        } else {
+            bucket.emplace_back(ordinal);
+        }
+    }
+
+    /* Place the biggest buckets first, while most slots are still free */
+    std::vector<std::size_t> bucketOrder(bucketCount);
+    for (std::size_t bucket = 0; bucket < bucketCount; bucket++) {
+        bucketOrder[bucket] = bucket;
+    }
+
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&buckets](std::size_t a, std::size_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<std::size_t> slots;
+    for (auto bucket : bucketOrder) {
+        const auto &ordinals = buckets[bucket];
+        if (ordinals.empty()) {
+            break;
+        }
+
+        bool placed = false;
+        for (uint32_t seed = 1; seed < MAX_BUCKET_SEED && !placed; seed++) {
+            slots.clear();
+            placed = true;
+
+            for (auto ordinal : ordinals) {
+                auto nameHash = std::hash<std::string>()(this->options[ordinal]->getName().raw());
+                auto slot = getSlotHash(nameHash, seed) & (slotCount - 1);
+
+                if (this->slotOrdinals[slot] != DRIVER_SCHEMA_NO_ORDINAL
+                    || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    placed = false;
+                    break;
+                }
+
+                slots.emplace_back(slot);
+            }
+
+            if (placed) {
+                this->bucketSeeds[bucket] = seed;
+                for (std::size_t i = 0; i < ordinals.size(); i++) {
+                    this->slotOrdinals[slots[i]] = ordinals[i];
+                }
+            }
+        }
+
+        if (!placed) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const std::list<Section> &DriverSchema::getSections() const {
+    return this->sections;
+}
+
+const std::vector<const DriverOption *> &DriverSchema::getOptions() const {
+    return this->options;
+}
+
+std::size_t DriverSchema::findOrdinal(const Glib::ustring &name) const {
+    const auto &rawName = name.raw();
+
+    auto nameHash = std::hash<std::string>()(rawName);
+    auto seed = this->bucketSeeds[nameHash & (this->bucketSeeds.size() - 1)];
+    if (seed == 0) {
+        return DRIVER_SCHEMA_NO_ORDINAL;
+    }
+
+    auto ordinal = this->slotOrdinals[getSlotHash(nameHash, seed) & (this->slotOrdinals.size() - 1)];
+
+    /* Names the driver doesn't know land on any slot */
+    if (ordinal == DRIVER_SCHEMA_NO_ORDINAL || this->options[ordinal]->getName().raw() != rawName) {
+        return DRIVER_SCHEMA_NO_ORDINAL;
+    }
+
+    return ordinal;
+}
+
+const DriverOption *DriverSchema::findOption(const Glib::ustring &name) const {
+    auto ordinal = this->findOrdinal(name);
+    if (ordinal == DRIVER_SCHEMA_NO_ORDINAL) {
+        return nullptr;
+    }
+
+    return this->options[ordinal];
+}
+
+std::size_t DriverSchema::getIndexBytes() const {
+    return this->bucketSeeds.capacity() * sizeof(uint32_t) + this->slotOrdinals.capacity() * sizeof(std::size_t);
+}
@@ -0,0 +1,61 @@
+#ifndef ADRICONF_DRIVERSCHEMA_H
+#define ADRICONF_DRIVERSCHEMA_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glibmm/ustring.h>
+#include "Section.h"
+
+/* Returned by findOrdinal for the options the driver doesn't support */
+#define DRIVER_SCHEMA_NO_ORDINAL static_cast<std::size_t>(-1)
+
+/**
+ * The options a driver supports, as parsed from its XML
+ * A schema never changes once built, so every configuration of the same driver shares one instance.
+ * The flat views are built once and point to the options inside the sections.
+ *
+ * Option names are resolved to their ordinal (the position in getOptions()) through a perfect hash built
+ * with the schema: names are spread in buckets, and each bucket gets the seed that sends all of its names
+ * to free slots. A lookup is then one hash of the name, one slot and a single name comparison.
+ */
+class DriverSchema {
+private:
+    std::list<Section> sections;
+    std::vector<const DriverOption *> options;
+    /* Seed of each bucket, and the ordinal held by each slot */
+    std::vector<uint32_t> bucketSeeds;
+    std::vector<std::size_t> slotOrdinals;
+
+    static uint64_t getSlotHash(uint64_t nameHash, uint32_t seed);
+
+    bool buildIndex(std::size_t bucketCount, std::size_t slotCount);
+
+public:
+    /* The options of each section are sorted to be more user-friendly */
+    explicit DriverSchema(std::list<Section> sections);
+
+    const std::list<Section> &getSections() const;
+
+    /* Every option of every section, in display order */
+    const std::vector<const DriverOption *> &getOptions() const;
+
+    /* Position of the option in getOptions(), or DRIVER_SCHEMA_NO_ORDINAL */
+    std::size_t findOrdinal(const Glib::ustring &name) const;
+
+    /* nullptr when the driver doesn't support the option */
+    const DriverOption *findOption(const Glib::ustring &name) const;
+
+    /* Bytes used by the name index */
+    std::size_t getIndexBytes() const;
+
+    DriverSchema(const DriverSchema &) = delete;
+
+    DriverSchema &operator=(const DriverSchema &) = delete;
+};
+
+typedef std::shared_ptr<const DriverSchema> DriverSchema_ptr;
+
+#endif
@@ -0,0 +1,162 @@
+#include "EffectiveConfiguration.h"
+
+EffectiveConfiguration::EffectiveConfiguration(
+        const Device_ptr &systemWideDevice,
+        const std::list<DriverConfiguration> &driverAvailableOptions,
+        const std::list<Device_ptr> &userDefinedDevices
+) {
+    /* Each device is compiled only once, no matter how many drivers use it */
+    std::map<const Device *, std::shared_ptr<ApplicationMatcher>> matchers;
+    std::list<std::pair<Source, Device_ptr>> layerDevices;
+
+    layerDevices.emplace_back(Source::SYSTEM_WIDE, systemWideDevice);
+    for (const auto &userDefinedDevice : userDefinedDevices) {
+        layerDevices.emplace_back(Source::USER_DEFINED, userDefinedDevice);
+    }
+
+    for (const auto &layerDevice : layerDevices) {
+        this->devices.emplace_back(layerDevice.second);
+        matchers[layerDevice.second.get()] = std::make_shared<ApplicationMatcher>(layerDevice.second);
+    }
+
+    for (const auto &driverConf : driverAvailableOptions) {
+        if (driverConf.getSchema() == nullptr) {
+            continue;
+        }
+
+        auto &driverLayers = this->drivers[std::make_pair(driverConf.getDriver(), driverConf.getScreen())];
+        driverLayers.schema = driverConf.getSchema();
+
+        for (const auto driverOption : driverLayers.schema->getOptions()) {
+            Value value;
+            value.name = &driverOption->getName();
+            value.value = &driverOption->getDefaultValue();
+            value.source = Source::DRIVER_DEFAULT;
+            value.application = nullptr;
+
+            driverLayers.defaults.emplace_back(value);
+        }
+
+        for (const auto &layerDevice : layerDevices) {
+            if (!deviceApplies(layerDevice.second, driverConf.getDriver(), driverConf.getScreen())) {
+                continue;
+            }
+
+            driverLayers.layers.emplace_back(compileLayer(
+                    layerDevice.first,
+                    matchers[layerDevice.second.get()],
+                    layerDevice.second,
+                    *driverLayers.schema
+            ));
+        }
+    }
+}
+
+bool EffectiveConfiguration::deviceApplies(const Device_ptr &device, const Glib::ustring &driver, int screen) {
+    /* Same as Mesa: a device without driver or screen applies to all of them */
+    return (device->getDriver().empty() || device->getDriver() == driver)
+           && (device->getScreen() < 0 || device->getScreen() == screen);
+}
+
+EffectiveConfiguration::Layer EffectiveConfiguration::compileLayer(
+        Source source,
+        const std::shared_ptr<ApplicationMatcher> &matcher,
+        const Device_ptr &device,
+        const DriverSchema &schema
+) {
+    Layer layer;
+    layer.source = source;
+    layer.matcher = matcher;
+
+    for (const auto &application : device->getApplications()) {
+        auto &compiledOptions = layer.options[application.get()];
+
+        for (const auto &option : application->getOptions()) {
+            auto ordinal = schema.findOrdinal(option->getName());
+
+            /* The driver ignores the options it doesn't support */
+            if (ordinal != DRIVER_SCHEMA_NO_ORDINAL) {
+                compiledOptions.emplace_back(ordinal, &option->getValue());
+            }
+        }
+    }
+
+    return layer;
+}
+
+std::vector<EffectiveConfiguration::Value> EffectiveConfiguration::query(
+        const ApplicationMatcher::Process &process,
+        const Glib::ustring &driver,
+        int screen
+) const {
+    auto driverLayers = this->drivers.find(std::make_pair(driver, screen));
+    if (driverLayers == this->drivers.end()) {
+        return std::vector<Value>();
+    }
+
+    std::vector<Value> values(driverLayers->second.defaults);
+
+    for (const auto &layer : driverLayers->second.layers) {
+        for (const auto &application : layer.matcher->match(process)) {
+            auto compiledOptions = layer.options.find(application.get());
+            if (compiledOptions == layer.options.end()) {
+                continue;
+            }
+
+            for (const auto &option : compiledOptions->second) {
+                auto &value = values[option.first];
+                value.value = option.second;
+                value.source = layer.source;
+                value.application = application.get();
+            }
+        }
+    }
+
+    return values;
+}
+
+std::vector<std::vector<EffectiveConfiguration::Value>> EffectiveConfiguration::query(
+        const std::vector<Query> &queries
+) const {
+    std::vector<std::vector<Value>> results;
+    results.reserve(queries.size());
+
+    for (const auto &query : queries) {
+        results.emplace_back(this->query(query.process, query.driver, query.screen));
+    }
+
+    return results;
+}
+
+Glib::ustring EffectiveConfiguration::sourceToString(Source source) {
+    switch (source) {
+        case Source::SYSTEM_WIDE:
+            return "system-wide";
+        case Source::USER_DEFINED:
+            return "user";
+        case Source::DRIVER_DEFAULT:
+        default:
+            return "driver-default";
+    }
+}
+
+void EffectiveConfiguration::appendValues(std::string &output, const Query &query, const std::vector<Value> &values) {
+    for (const auto &value : values) {
+        output.append(query.process.executable.raw());
+        output.append("\t");
+        output.append(query.driver.raw());
+        output.append("\t");
+        output.append(std::to_string(query.screen));
+        output.append("\t");
+        output.append(value.name->raw());
+        output.append("\t");
+        output.append(value.value->raw());
+        output.append("\t");
+        output.append(sourceToString(value.source).raw());
+        output.append("\t");
+        if (value.application != nullptr) {
+            output.append(value.application->getName().raw());
+        }
+        output.append("\n");
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef ADRICONF_EFFECTIVECONFIGURATION_H
+#define ADRICONF_EFFECTIVECONFIGURATION_H
+
+#include <glibmm/ustring.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ApplicationMatcher.h"
+#include "Device.h"
+#include "DriverConfiguration.h"
+
+/**
+ * Layered lookup of the final option values of a process
+ * Everything is compiled once: the driver defaults, the system-wide and the user-defined applications,
+ * with their options already resolved to the position of the option in the driver.
+ * Precedence: userDefined > System Wide > Driver Default, and inside a layer later applications win.
+ */
+class EffectiveConfiguration {
+public:
+    enum class Source {
+        DRIVER_DEFAULT,
+        SYSTEM_WIDE,
+        USER_DEFINED
+    };
+
+    /* The final value of an option and where it came from */
+    struct Value {
+        const Glib::ustring *name;
+        const Glib::ustring *value;
+        Source source;
+        /* The application that set the value, null for driver defaults */
+        const Application *application;
+    };
+
+    struct Query {
+        ApplicationMatcher::Process process;
+        Glib::ustring driver;
+        int screen;
+    };
+
+private:
+    typedef std::vector<std::pair<std::size_t, const Glib::ustring *>> CompiledOptions;
+
+    struct Layer {
+        Source source;
+        std::shared_ptr<ApplicationMatcher> matcher;
+        std::unordered_map<const Application *, CompiledOptions> options;
+    };
+
+    struct DriverLayers {
+        /* The values point to the names and defaults inside the schema */
+        DriverSchema_ptr schema;
+        std::vector<Value> defaults;
+        std::vector<Layer> layers;
+    };
+
+    /* Keep the data alive, as the compiled structure only points to it */
+    std::list<Device_ptr> devices;
+    std::map<std::pair<Glib::ustring, int>, DriverLayers> drivers;
+
+    static Layer compileLayer(
+            Source source,
+            const std::shared_ptr<ApplicationMatcher> &matcher,
+            const Device_ptr &device,
+            const DriverSchema &schema
+    );
+
+public:
+    /* The devices are not copied, so they must not be changed while this object is in use */
+    EffectiveConfiguration(
+            const Device_ptr &systemWideDevice,
+            const std::list<DriverConfiguration> &driverAvailableOptions,
+            const std::list<Device_ptr> &userDefinedDevices
+    );
+
+    /**
+     * Resolve the final value of every option the driver supports
+     * @param process
+     * @param driver
+     * @param screen
+     * @return The options in driver order, empty if the driver isn't loaded for this screen
+     */
+    std::vector<Value> query(const ApplicationMatcher::Process &process, const Glib::ustring &driver, int screen) const;
+
+    /* Resolve a batch of queries, in the same order */
+    std::vector<std::vector<Value>> query(const std::vector<Query> &queries) const;
+
+    static Glib::ustring sourceToString(Source source);
+
+    /* Check if the options of a device are used by a driver and screen */
+    static bool deviceApplies(const Device_ptr &device, const Glib::ustring &driver, int screen);
+
+    /**
+     * Append the values as tab-separated lines: executable, driver, screen, option, value, source and application
+     * This is the output of the query command and the configuration daemon
+     */
+    static void appendValues(std::string &output, const Query &query, const std::vector<Value> &values);
+
+    EffectiveConfiguration(const EffectiveConfiguration &) = delete;
+
+    EffectiveConfiguration &operator=(const EffectiveConfiguration &) = delete;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "CommandLine.h"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <glibmm/i18n.h>
+#include "ConfigurationLoader.h"
+#include "EffectiveConfiguration.h"
+
+int CommandLine::runQuery(int argc, char *argv[]) {
+    Glib::ustring driver;
+    int screen = -1;
+    ApplicationMatcher::Process baseProcess;
+    std::vector<std::string> executables;
+
+    for (int i = 2; i < argc; i++) {
+        std::string argument(argv[i]);
+        bool hasValue = i + 1 < argc;
+
+        try {
+            if (argument == "--driver" && hasValue) {
+                driver = argv[++i];
+            } else if (argument == "--screen" && hasValue) {
+                screen = std::stoi(argv[++i]);
+            } else if (argument == "--application-name" && hasValue) {
+                baseProcess.applicationName = argv[++i];
+            } else if (argument == "--application-version" && hasValue) {
+                baseProcess.applicationVersion = std::stoi(argv[++i]);
+            } else if (argument == "--engine-name" && hasValue) {
+                baseProcess.engineName = argv[++i];
+            } else if (argument == "--engine-version" && hasValue) {
+                baseProcess.engineVersion = std::stoi(argv[++i]);
+            } else if (argument.compare(0, 2, "--") == 0) {
+                printUsage();
+                return 1;
+            } else {
+                executables.emplace_back(argument);
+            }
+        } catch (const std::exception &ex) {
+            std::cerr << Glib::ustring::compose(_("Invalid value for %1"), argument) << std::endl;
+            return 1;
+        }
+    }
+
+    if (executables.empty()) {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (!line.empty()) {
+                executables.emplace_back(line);
+            }
+        }
+    }
+
+    ConfigurationLoader configurationLoader;
+    auto configuration = configurationLoader.loadConcurrently(
+            HEADLESS_LOCALE,
+            ConfigurationLoader::DRIVERS | ConfigurationLoader::SYSTEM_WIDE | ConfigurationLoader::USER_DEFINED
+    );
+    auto &driverConfiguration = configuration.driverConfiguration;
+    auto &systemWideConfiguration = configuration.systemWideConfiguration;
+    auto &userDefinedConfiguration = configuration.userDefinedConfiguration;
+
+    EffectiveConfiguration effectiveConfiguration(
+            systemWideConfiguration,
+            driverConfiguration,
+            userDefinedConfiguration
+    );
+
+    /* Without a driver or screen filter we answer for every loaded driver */
+    std::vector<std::pair<Glib::ustring, int>> targets;
+    for (const auto &driverConf : driverConfiguration) {
+        if ((driver.empty() || driverConf.getDriver() == driver)
+            && (screen < 0 || driverConf.getScreen() == screen)) {
+            targets.emplace_back(driverConf.getDriver(), driverConf.getScreen());
+        }
+    }
+
+    if (targets.empty()) {
+        std::cerr << _("No loaded driver matches the given driver and screen.") << std::endl;
+        return 1;
+    }
+
+    std::vector<EffectiveConfiguration::Query> queries;
+    for (const auto &executable : executables) {
+        for (const auto &target : targets) {
+            EffectiveConfiguration::Query query;
+            query.process = baseProcess;
+            query.process.setExecutable(executable);
+            query.driver = target.first;
+            query.screen = target.second;
+            queries.emplace_back(query);
+        }
+    }
+
+    auto results = effectiveConfiguration.query(queries);
+
+    std::string output;
+    for (std::size_t i = 0; i < queries.size(); i++) {
+        EffectiveConfiguration::appendValues(output, queries[i], results[i]);
+    }
+    std::cout << output;
+
+    return 0;
+}
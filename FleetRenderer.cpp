@@ -0,0 +1,88 @@
+#include "FleetRenderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include <glibmm/i18n.h>
+#include <libxml/parser.h>
+#include "Parser.h"
+
+namespace {
+    ConfigurationSaver::Result renderJob(
+            const Device_ptr &systemWideDevice,
+            const std::list<DriverConfiguration> &driverConfiguration,
+            const FleetRenderer::Job &job,
+            std::string &buffer
+    ) {
+        ConfigurationSaver::Result result;
+        result.state = ConfigurationSaver::State::FAILED;
+
+        std::ifstream input(job.overlayPath, std::ios::binary);
+        if (!input.good()) {
+            result.error = Glib::ustring::compose(_("Couldn't read file %1"), job.overlayPath);
+            return result;
+        }
+
+        /* The buffer belongs to the worker and keeps its capacity between jobs */
+        input.seekg(0, std::ios::end);
+        buffer.resize(static_cast<std::size_t>(std::max<std::streamoff>(input.tellg(), 0)));
+        input.seekg(0, std::ios::beg);
+        input.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+
+        /* A partial overlay would silently drop the user's options from the written file */
+        Glib::ustring parseError;
+        auto userDefinedDevices = Parser::parseDevicesRaw(buffer, &parseError);
+        if (!parseError.empty()) {
+            result.error = Glib::ustring::compose(_("Couldn't parse file %1: %2"), job.overlayPath, parseError);
+            return result;
+        }
+
+        return ConfigurationSaver::writeFile(systemWideDevice, driverConfiguration, userDefinedDevices,
+                                             job.outputPath);
+    }
+}
+
+std::vector<ConfigurationSaver::Result> FleetRenderer::render(
+        const Device_ptr &systemWideDevice,
+        const std::list<DriverConfiguration> &driverConfiguration,
+        const std::vector<Job> &jobs,
+        unsigned int threadCount
+) {
+    std::vector<ConfigurationSaver::Result> results(jobs.size());
+
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    if (threadCount > jobs.size()) {
+        threadCount = static_cast<unsigned int>(jobs.size());
+    }
+
+    /* libxml2 must be initialized once before being used from several threads */
+    xmlInitParser();
+
+    /* Each result slot is written by the worker that took the job, so they need no lock */
+    std::atomic<std::size_t> nextJob(0);
+    auto worker = [&]() {
+        std::string buffer;
+        std::size_t jobIndex;
+
+        while ((jobIndex = nextJob.fetch_add(1, std::memory_order_relaxed)) < jobs.size()) {
+            results[jobIndex] = renderJob(systemWideDevice, driverConfiguration, jobs[jobIndex], buffer);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threadCount; i++) {
+        workers.emplace_back(worker);
+    }
+
+    /* The calling thread is also a worker */
+    worker();
+
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    return results;
+}
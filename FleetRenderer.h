@@ -0,0 +1,40 @@
+#ifndef ADRICONF_FLEETRENDERER_H
+#define ADRICONF_FLEETRENDERER_H
+
+#include <list>
+#include <string>
+#include <vector>
+#include "ConfigurationSaver.h"
+#include "Device.h"
+#include "DriverConfiguration.h"
+
+/**
+ * Write the drirc of many users at once, each one being the shared system-wide base plus a user overlay
+ * The base and the driver schemas are loaded once and only read by the workers, every overlay is parsed,
+ * resolved and written by a single worker, so no lock is taken while rendering.
+ */
+namespace FleetRenderer {
+    struct Job {
+        /* A drirc with the user-defined options */
+        std::string overlayPath;
+        /* Where the resolved drirc is written */
+        std::string outputPath;
+    };
+
+    /**
+     * Render every job on a pool of threads
+     * @param systemWideDevice
+     * @param driverConfiguration
+     * @param jobs
+     * @param threadCount Number of workers, 0 to use one per CPU
+     * @return The result of each job, in the same order
+     */
+    std::vector<ConfigurationSaver::Result> render(
+            const Device_ptr &systemWideDevice,
+            const std::list<DriverConfiguration> &driverConfiguration,
+            const std::vector<Job> &jobs,
+            unsigned int threadCount
+    );
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "CommandLine.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <glibmm/i18n.h>
+#include "ConfigurationLoader.h"
+#include "FleetRenderer.h"
+#include "Parser.h"
+
+int CommandLine::runFleet(int argc, char *argv[]) {
+    unsigned int threadCount = 0;
+    std::string systemWidePath;
+    std::string manifestPath;
+
+    for (int i = 2; i < argc; i++) {
+        std::string argument(argv[i]);
+        bool hasValue = i + 1 < argc;
+
+        try {
+            if (argument == "--jobs" && hasValue) {
+                threadCount = static_cast<unsigned int>(std::stoul(argv[++i]));
+            } else if (argument == "--system-wide" && hasValue) {
+                systemWidePath = argv[++i];
+            } else if (argument.compare(0, 2, "--") == 0 || !manifestPath.empty()) {
+                printUsage();
+                return 1;
+            } else {
+                manifestPath = argument;
+            }
+        } catch (const std::exception &ex) {
+            std::cerr << Glib::ustring::compose(_("Invalid value for %1"), argument) << std::endl;
+            return 1;
+        }
+    }
+
+    std::ifstream manifestFile;
+    if (!manifestPath.empty()) {
+        manifestFile.open(manifestPath);
+        if (!manifestFile.good()) {
+            std::cerr << Glib::ustring::compose(_("Couldn't read file %1"), manifestPath) << std::endl;
+            return 1;
+        }
+    }
+    std::istream &manifest = manifestPath.empty() ? std::cin : manifestFile;
+
+    std::vector<FleetRenderer::Job> jobs;
+    std::string line;
+    while (std::getline(manifest, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        auto separator = line.find('\t');
+        if (separator == std::string::npos) {
+            std::cerr << Glib::ustring::compose(_("Invalid manifest line: %1"), line) << std::endl;
+            return 1;
+        }
+
+        FleetRenderer::Job job;
+        job.overlayPath = line.substr(0, separator);
+        job.outputPath = line.substr(separator + 1);
+        jobs.emplace_back(job);
+    }
+
+    /* The base and the schemas are loaded once and shared by every job */
+    ConfigurationLoader configurationLoader;
+    auto configuration = configurationLoader.loadConcurrently(
+            HEADLESS_LOCALE,
+            ConfigurationLoader::DRIVERS | (systemWidePath.empty() ? ConfigurationLoader::SYSTEM_WIDE : 0)
+    );
+    auto &driverConfiguration = configuration.driverConfiguration;
+    auto &systemWideConfiguration = configuration.systemWideConfiguration;
+
+    if (!systemWidePath.empty()) {
+        std::ifstream input(systemWidePath);
+        if (!input.good()) {
+            std::cerr << Glib::ustring::compose(_("Couldn't read file %1"), systemWidePath) << std::endl;
+            return 1;
+        }
+
+        std::ostringstream buffer;
+        buffer << input.rdbuf();
+
+        /* Every output would be missing the base, so a broken file stops the whole run */
+        Glib::ustring error;
+        auto devices = Parser::parseDevicesRaw(buffer.str(), &error);
+        if (!error.empty()) {
+            std::cerr << Glib::ustring::compose(_("Couldn't parse file %1: %2"), systemWidePath, error) << std::endl;
+            return 1;
+        }
+
+        systemWideConfiguration = devices.empty() ? std::make_shared<Device>() : devices.front();
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto results = FleetRenderer::render(systemWideConfiguration, driverConfiguration, jobs, threadCount);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime
+    );
+
+    std::size_t written = 0, unchanged = 0, failed = 0;
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        const auto &result = results[i];
+
+        switch (result.state) {
+            case ConfigurationSaver::State::WRITTEN:
+                written++;
+                std::cout << jobs[i].outputPath << "\twritten\t" << result.messages.size() << std::endl;
+                break;
+
+            case ConfigurationSaver::State::UNCHANGED:
+                unchanged++;
+                std::cout << jobs[i].outputPath << "\tunchanged\t" << result.messages.size() << std::endl;
+                break;
+
+            case ConfigurationSaver::State::FAILED:
+                failed++;
+                std::cout << jobs[i].outputPath << "\tfailed\t" << result.error << std::endl;
+                break;
+        }
+    }
+
+    std::cerr << Glib::ustring::compose(
+            _("%1 files in %2 ms: %3 written, %4 unchanged, %5 failed"),
+            jobs.size(), elapsed.count(), written, unchanged, failed
+    ) << std::endl;
+
+    return failed == 0 ? 0 : 2;
+}
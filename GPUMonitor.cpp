@@ -0,0 +1,118 @@
+#include "GPUMonitor.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <glibmm/i18n.h>
+
+namespace {
+    bool isDeviceNode(const char *name) {
+        return std::strncmp(name, "card", 4) == 0 || std::strncmp(name, "renderD", 7) == 0;
+    }
+
+    std::string parentDirectory(const std::string &path) {
+        auto separator = path.find_last_of('/');
+        if (separator == std::string::npos) {
+            return ".";
+        }
+
+        return separator == 0 ? "/" : path.substr(0, separator);
+    }
+}
+
+GPUMonitor::GPUMonitor(std::string directory) : directory(std::move(directory)), inotifyFd(-1), directoryWatch(-1) {}
+
+GPUMonitor::~GPUMonitor() {
+    this->ioWatch.disconnect();
+    this->settleTimeout.disconnect();
+
+    if (this->inotifyFd >= 0) {
+        close(this->inotifyFd);
+    }
+}
+
+std::string GPUMonitor::getDefaultDirectory() {
+    const char *directory = std::getenv("ADRICONF_DRI_DIR");
+    if (directory != nullptr && directory[0] != '\0') {
+        return directory;
+    }
+
+    return GPU_MONITOR_DEFAULT_DIRECTORY;
+}
+
+bool GPUMonitor::start() {
+    this->inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->inotifyFd < 0) {
+        std::cerr << Glib::ustring::compose(_("Couldn't watch the GPUs: %1"), std::strerror(errno)) << std::endl;
+        return false;
+    }
+
+    if (!this->watchDirectory()) {
+        auto parent = parentDirectory(this->directory);
+
+        if (inotify_add_watch(this->inotifyFd, parent.c_str(), IN_CREATE | IN_MOVED_TO) < 0) {
+            std::cerr << Glib::ustring::compose(_("Couldn't watch %1: %2"), parent, std::strerror(errno))
+                      << std::endl;
+        }
+    }
+
+    this->ioWatch = Glib::signal_io().connect(
+            sigc::mem_fun(this, &GPUMonitor::onInotifyReadable), this->inotifyFd, Glib::IO_IN
+    );
+
+    return true;
+}
+
+bool GPUMonitor::watchDirectory() {
+    this->directoryWatch = inotify_add_watch(this->inotifyFd, this->directory.c_str(),
+                                             IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM);
+
+    return this->directoryWatch >= 0;
+}
+
+bool GPUMonitor::onInotifyReadable(Glib::IOCondition condition) {
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+    auto directoryName = this->directory.substr(this->directory.find_last_of('/') + 1);
+
+    ssize_t length;
+    while ((length = read(this->inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for (char *position = buffer; position < buffer + length;) {
+            auto event = reinterpret_cast<inotify_event *>(position);
+
+            if (event->len > 0) {
+                if (event->wd == this->directoryWatch && isDeviceNode(event->name)) {
+                    changed = true;
+                } else if (event->wd != this->directoryWatch && directoryName == event->name) {
+                    /* The first GPU created the directory, its nodes may already be inside */
+                    changed = this->watchDirectory();
+                }
+            }
+
+            position += sizeof(inotify_event) + event->len;
+        }
+    }
+
+    if (changed) {
+        this->settleTimeout.disconnect();
+        this->settleTimeout = Glib::signal_timeout().connect(
+                sigc::mem_fun(this, &GPUMonitor::onSettled), GPU_MONITOR_SETTLE_DELAY
+        );
+    }
+
+    return true;
+}
+
+bool GPUMonitor::onSettled() {
+    this->changedSignal.emit();
+
+    /* Run only once, the next change schedules it again */
+    return false;
+}
+
+sigc::signal<void> &GPUMonitor::signalChanged() {
+    return this->changedSignal;
+}
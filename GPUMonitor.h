@@ -0,0 +1,52 @@
+#ifndef ADRICONF_GPUMONITOR_H
+#define ADRICONF_GPUMONITOR_H
+
+#include <string>
+#include <glibmm.h>
+
+#define GPU_MONITOR_DEFAULT_DIRECTORY "/dev/dri"
+
+/* Time without new device nodes before reporting, udev creates the card and render nodes one by one */
+#define GPU_MONITOR_SETTLE_DELAY 500
+
+/**
+ * Notice DRM devices being added or removed, like an eGPU being docked
+ * The device node directory is watched with inotify from the main loop, and the changed signal is
+ * emitted once the nodes stop changing. When the directory doesn't exist yet (no GPU at all) its
+ * parent is watched until it's created.
+ */
+class GPUMonitor {
+private:
+    std::string directory;
+    int inotifyFd;
+    int directoryWatch;
+    sigc::connection ioWatch;
+    sigc::connection settleTimeout;
+    sigc::signal<void> changedSignal;
+
+    bool watchDirectory();
+
+    bool onInotifyReadable(Glib::IOCondition condition);
+
+    bool onSettled();
+
+public:
+    /* @param directory Where the device nodes are created, see getDefaultDirectory */
+    explicit GPUMonitor(std::string directory);
+
+    virtual ~GPUMonitor();
+
+    /* $ADRICONF_DRI_DIR, or /dev/dri */
+    static std::string getDefaultDirectory();
+
+    /* @return false if inotify isn't available */
+    bool start();
+
+    sigc::signal<void> &signalChanged();
+
+    GPUMonitor(const GPUMonitor &) = delete;
+
+    GPUMonitor &operator=(const GPUMonitor &) = delete;
+};
+
+#endif
@@ -4,23 +4,38 @@
 #include "Parser.h"
 #include "ConfigurationResolver.h"
 #include "DRIQuery.h"
-#include "Writer.h"
+#include "ConfigurationValidator.h"
+#include "ConfigurationHistory.h"
+#include "MemoryReport.h"
 #include <iostream>
 #include <fstream>
 
-GUI::GUI() : currentApp(nullptr), currentDriver(nullptr) {
+#ifdef GDK_WINDOWING_X11
+#include <gdk/gdkx.h>
+#endif
+
+GUI::GUI(unsigned int autosaveDelay) : pUndoAction(nullptr), pRedoAction(nullptr), pOptionListAction(nullptr),
+                                        pOptionStack(nullptr), currentApp(nullptr), currentDriver(nullptr),
+                                        autosaveDelay(autosaveDelay) {
     this->setupLocale();
 
     /* Load the configurations */
     ConfigurationLoader configurationLoader;
-    this->driverConfiguration = configurationLoader.loadDriverSpecificConfiguration(this->locale);
-    for (auto &driver : this->driverConfiguration) {
-        driver.sortSectionOptions();
+
+#ifdef GDK_WINDOWING_X11
+    /* Avoid opening a second X connection when GDK already has one */
+    auto gdkDisplay = gdk_display_get_default();
+    if (gdkDisplay != nullptr && GDK_IS_X11_DISPLAY(gdkDisplay)) {
+        configurationLoader.setDisplay(gdk_x11_display_get_xdisplay(gdkDisplay));
     }
+#endif
 
-    this->systemWideConfiguration = configurationLoader.loadSystemWideConfiguration();
-    this->userDefinedConfiguration = configurationLoader.loadUserDefinedConfiguration();
-    this->availableGPUs = configurationLoader.loadAvailableGPUs();
+    /* The drivers are queried here while the drirc files and the GPU list load on other threads */
+    auto configuration = configurationLoader.loadConcurrently(this->locale);
+    this->driverConfiguration = std::move(configuration.driverConfiguration);
+    this->systemWideConfiguration = std::move(configuration.systemWideConfiguration);
+    this->userDefinedConfiguration = std::move(configuration.userDefinedConfiguration);
+    this->availableGPUs = std::move(configuration.availableGPUs);
 
     /* Merge all the options in a complete structure */
     ConfigurationResolver::mergeOptionsForDisplay(
@@ -35,6 +50,24 @@ GUI::GUI() : currentApp(nullptr), currentDriver(nullptr) {
             this->userDefinedConfiguration
     );
 
+    /* Report the values that don't fit the driver schema */
+    for (const auto &diagnostic : ConfigurationValidator::validate(
+            this->driverConfiguration,
+            this->userDefinedConfiguration
+    )) {
+        std::cerr << ConfigurationValidator::describe(diagnostic) << std::endl;
+    }
+
+    /* Sort the applications to maintain a good human GUI */
+    for (auto &driver : this->userDefinedConfiguration) {
+        driver->sortApplications();
+    }
+
+    /* From now on the configuration is only changed through the history */
+    this->history.reset(this->userDefinedConfiguration);
+
+    this->saver.signalFinished().connect(sigc::mem_fun(this, &GUI::onSaveFinished));
+
     /* Load the GUI file */
     this->gladeBuilder = Gtk::Builder::create();
     this->gladeBuilder->add_from_resource("/jlHertel/adriconf/DriConf.glade");
@@ -63,6 +96,25 @@ GUI::GUI() : currentApp(nullptr), currentDriver(nullptr) {
         pSaveAction->signal_activate().connect(sigc::mem_fun(this, &GUI::onSavePressed));
     }
 
+    /* Extract the undo/redo menus */
+    auto accelGroup = Gtk::AccelGroup::create();
+    this->pWindow->add_accel_group(accelGroup);
+
+    this->gladeBuilder->get_widget("undoAction", this->pUndoAction);
+    if (this->pUndoAction) {
+        this->pUndoAction->signal_activate().connect(sigc::mem_fun(this, &GUI::onUndoPressed));
+        this->pUndoAction->add_accelerator("activate", accelGroup, GDK_KEY_z, Gdk::CONTROL_MASK, Gtk::ACCEL_VISIBLE);
+    }
+
+    this->gladeBuilder->get_widget("redoAction", this->pRedoAction);
+    if (this->pRedoAction) {
+        this->pRedoAction->signal_activate().connect(sigc::mem_fun(this, &GUI::onRedoPressed));
+        this->pRedoAction->add_accelerator("activate", accelGroup, GDK_KEY_z,
+                                           Gdk::CONTROL_MASK | Gdk::SHIFT_MASK, Gtk::ACCEL_VISIBLE);
+    }
+
+    this->updateHistoryActions();
+
     /* Create the menu itens */
     this->pMenuAddApplication = Gtk::manage(new Gtk::MenuItem);
     this->pMenuAddApplication->set_visible(true);
@@ -74,17 +126,62 @@ GUI::GUI() : currentApp(nullptr), currentDriver(nullptr) {
     this->pMenuRemoveApplication->set_label(_("Remove current Application"));
     this->pMenuRemoveApplication->signal_activate().connect(sigc::mem_fun(this, &GUI::onRemoveApplicationPressed));
 
-    /* Extract & generate the menu with the applications */
-    this->drawApplicationSelectionMenu();
+    Gtk::Menu *pApplicationMenu;
+    this->gladeBuilder->get_widget("ApplicationMenu", pApplicationMenu);
+    if (pApplicationMenu) {
+        pApplicationMenu->add(*this->pMenuAddApplication);
+        pApplicationMenu->add(*this->pMenuRemoveApplication);
+    }
+
+    /* Extract & generate the list with the applications */
+    Gtk::TreeView *pApplicationTreeView;
+    this->gladeBuilder->get_widget("applicationList", pApplicationTreeView);
+    if (!pApplicationTreeView) {
+        std::cerr << _("Application list object not found in glade file!") << std::endl;
+        return;
+    }
+
+    Gtk::SearchEntry *pApplicationSearch;
+    this->gladeBuilder->get_widget("applicationSearch", pApplicationSearch);
+
+    this->applicationList.reset(new ApplicationList(pApplicationTreeView, pApplicationSearch));
+    this->applicationList->signalSelected().connect(sigc::mem_fun(this, &GUI::onApplicationSelected));
+    this->drawApplicationList();
+
+    /* Extract the alternative option view, used for drivers with too many options for one widget each */
+    this->gladeBuilder->get_widget("optionStack", this->pOptionStack);
+
+    Gtk::TreeView *pOptionTreeView;
+    this->gladeBuilder->get_widget("optionList", pOptionTreeView);
+    if (pOptionTreeView) {
+        this->optionList.reset(new OptionList(pOptionTreeView));
+        this->optionList->signalChanged().connect(sigc::mem_fun(this, &GUI::setCurrentAppOption));
+    }
+
+    this->gladeBuilder->get_widget("optionListAction", this->pOptionListAction);
+    if (this->pOptionListAction) {
+        this->pOptionListAction->signal_toggled().connect(sigc::mem_fun(this, &GUI::drawApplicationOptions));
+    }
 
     /* Draw the final screen */
     this->drawApplicationOptions();
 
     /* Setup the about dialog */
     this->setupAboutDialog();
+
+    /* Pick up the GPUs plugged in while running, like a docked eGPU */
+    this->gpuMonitor.reset(new GPUMonitor(GPUMonitor::getDefaultDirectory()));
+    this->gpuMonitor->signalChanged().connect(sigc::mem_fun(this, &GUI::onGPUsChanged));
+    this->gpuMonitor->start();
 }
 
 GUI::~GUI() {
+    /* Don't lose the changes still waiting for the autosave, the saver finishes them before exiting */
+    if (this->autosaveTimeout.connected()) {
+        this->autosaveTimeout.disconnect();
+        this->onSavePressed();
+    }
+
     delete this->pWindow;
 }
 
@@ -96,15 +193,50 @@ void GUI::onQuitPressed() {
 
 void GUI::onSavePressed() {
     std::cout << _("Generating final XML for saving...") << std::endl;
-    auto resolvedOptions = ConfigurationResolver::resolveOptionsForSave(
-            this->systemWideConfiguration, this->driverConfiguration, this->userDefinedConfiguration
-    );
-    auto rawXML = Writer::generateRawXml(resolvedOptions);
-    std::cout << Glib::ustring::compose(_("Writing generated XML: %1"), rawXML) << std::endl;
-    std::string userHome(std::getenv("HOME"));
-    std::ofstream outFile(userHome + "/.drirc");
-    outFile << rawXML;
-    outFile.close();
+
+    /* The current configuration is an immutable snapshot, so the UI can keep changing it during the save */
+    this->saver.save(this->systemWideConfiguration, this->driverConfiguration, this->userDefinedConfiguration);
+}
+
+void GUI::onSaveFinished(const ConfigurationSaver::Result &result) {
+    for (const auto &message : result.messages) {
+        std::cout << message << std::endl;
+    }
+
+    switch (result.state) {
+        case ConfigurationSaver::State::UNCHANGED:
+            std::cout << _("Configuration unchanged, skipping write.") << std::endl;
+            break;
+
+        case ConfigurationSaver::State::WRITTEN:
+            std::cout << _("Configuration saved.") << std::endl;
+            break;
+
+        case ConfigurationSaver::State::FAILED:
+        default:
+            std::cerr << result.error << std::endl;
+
+            if (this->pWindow != nullptr) {
+                Gtk::MessageDialog dialog(*(this->pWindow), _("The configuration could not be saved."), false,
+                                          Gtk::MESSAGE_ERROR);
+                dialog.set_secondary_text(result.error);
+                dialog.run();
+            }
+            break;
+    }
+}
+
+std::string GUI::describeMemoryUsage() const {
+    MemoryReport report;
+    report.addDriverConfigurations(this->driverConfiguration);
+    report.addDevice(this->systemWideConfiguration);
+
+    /* Snapshots share every application they didn't change, which are counted once */
+    for (const auto &snapshot : this->history.getSnapshots()) {
+        report.addDevices(snapshot);
+    }
+
+    return report.describe();
 }
 
 Gtk::Window *GUI::getWindowPointer() {
@@ -123,129 +255,87 @@ void GUI::setupLocale() {
     this->locale = langCode;
 }
 
-void GUI::drawApplicationSelectionMenu() {
-    Gtk::Menu *pApplicationMenu;
-    this->gladeBuilder->get_widget("ApplicationMenu", pApplicationMenu);
-
-    if (pApplicationMenu) {
-        /* Remove any item already defined */
-        for (auto &menuItem : pApplicationMenu->get_children()) {
-            pApplicationMenu->remove(*menuItem);
-        }
-
-        /* Clear the items already selected */
-        this->currentDriver = nullptr;
-        /* No need to set the current application executables, as the default doesn't have one */
-        this->currentApp = nullptr;
-
-        /* Sort the applications to maintain a good human GUI */
-        for (auto &driver : this->userDefinedConfiguration) {
-            driver->sortApplications();
-        }
-
-        /* Add the actions of add/remove apps */
-        pApplicationMenu->add(*this->pMenuAddApplication);
-        pApplicationMenu->add(*this->pMenuRemoveApplication);
-
-        Gtk::RadioButtonGroup appRadioGroup;
-        bool groupInitialized = false;
-
-        for (auto &driver : this->userDefinedConfiguration) {
-
-            if (this->currentDriver == nullptr) {
-                // Locate the driver config
-                auto foundDriver = std::find_if(this->driverConfiguration.begin(), this->driverConfiguration.end(),
-                                                [driver](const DriverConfiguration &d) {
-                                                    return d.getDriver() == driver->getDriver();
-                                                });
-                if (foundDriver == this->driverConfiguration.end()) {
-                    std::cerr << Glib::ustring::compose(_("Driver %1 not found"), driver) << std::endl;
-                }
-                this->currentDriver = &(*foundDriver);
-            }
-
-            Gtk::MenuItem *driverMenuItem = Gtk::manage(new Gtk::MenuItem);
-            driverMenuItem->set_visible(true);
-            driverMenuItem->set_label(driver->getDriver());
-
-            Gtk::Menu *driverSubMenu = Gtk::manage(new Gtk::Menu);
-            driverSubMenu->set_visible(true);
-            for (auto &possibleApp : driver->getApplications()) {
-                Gtk::RadioMenuItem *appMenuItem = Gtk::manage(new Gtk::RadioMenuItem);
-                appMenuItem->set_visible(true);
-                appMenuItem->set_label(possibleApp->getName());
-
-                if (!groupInitialized) {
-                    appRadioGroup = appMenuItem->get_group();
-                    groupInitialized = true;
-                } else {
-                    appMenuItem->set_group(appRadioGroup);
-                }
-
-                if (this->currentDriver->getDriver() == driver->getDriver() && possibleApp->getExecutable().empty()) {
-                    appMenuItem->set_active(true);
+void GUI::drawApplicationList() {
+    this->applicationList->populate(this->userDefinedConfiguration);
 
-                    this->currentApp = possibleApp;
-                }
-
-                appMenuItem->signal_toggled().connect(sigc::bind<Glib::ustring, Glib::ustring>(
-                        sigc::mem_fun(this, &GUI::onApplicationSelected),
-                        driver->getDriver(), possibleApp->getExecutable()
-                ));
+    /* Start with the default application of the first driver */
+    this->currentDriver = nullptr;
+    this->currentApp = nullptr;
 
-                driverSubMenu->append(*appMenuItem);
+    for (const auto &device : this->userDefinedConfiguration) {
+        for (const auto &app : device->getApplications()) {
+            if (app->isDefault() && this->setCurrentApplication(device, app)) {
+                return;
             }
-
-            driverMenuItem->set_submenu(*driverSubMenu);
-
-            pApplicationMenu->add(*driverMenuItem);
         }
     }
 }
 
-void GUI::onApplicationSelected(const Glib::ustring driverName, const Glib::ustring applicationName) {
-    if (driverName == this->currentDriver->getDriver() && applicationName == this->currentApp->getExecutable()) {
-        return;
+bool GUI::setCurrentApplication(const Device_ptr &device, const Application_ptr &application) {
+    auto driverSelected = std::find_if(this->driverConfiguration.begin(), this->driverConfiguration.end(),
+                                       [&device](const DriverConfiguration &d) {
+                                           return d.getDriver() == device->getDriver()
+                                                  && d.getScreen() == device->getScreen();
+                                       });
+
+    if (driverSelected == this->driverConfiguration.end()) {
+        std::cerr << Glib::ustring::compose(_("Driver %1 not found "), device->getDriver()) << std::endl;
+        return false;
     }
 
-    /* Find the application */
+    this->currentDriver = &(*driverSelected);
+    this->currentApp = application;
+    this->applicationList->select(device, *application);
+
+    return true;
+}
+
+void GUI::onApplicationSelected(const Glib::ustring &driverName, int screen, const Application_ptr &listedApp) {
+    /* Find the application, the listed one may be an older copy of it */
     auto userSelectedDriver = std::find_if(this->userDefinedConfiguration.begin(), this->userDefinedConfiguration.end(),
-                                           [driverName](Device_ptr device) {
-                                               return driverName == device->getDriver();
+                                           [&driverName, screen](Device_ptr device) {
+                                               return driverName == device->getDriver()
+                                                      && screen == device->getScreen();
                                            }
     );
-    auto selectedApp = std::find_if((*userSelectedDriver)->getApplications().begin(),
-                                    (*userSelectedDriver)->getApplications().end(),
-                                    [applicationName](Application_ptr app) {
-                                        return applicationName == app->getExecutable();
-                                    }
-    );
 
-    if (selectedApp == (*userSelectedDriver)->getApplications().end()) {
-        std::cerr << Glib::ustring::compose(_("Application %1 not found "), applicationName)
-                  << std::endl;
+    if (userSelectedDriver == this->userDefinedConfiguration.end()) {
+        std::cerr << Glib::ustring::compose(_("Driver %1 not found "), driverName) << std::endl;
         return;
     }
 
-    this->currentApp = *selectedApp;
-
-    auto driverSelected = std::find_if(this->driverConfiguration.begin(), this->driverConfiguration.end(),
-                                       [driverName](const DriverConfiguration &d) {
-                                           return d.getDriver() == driverName;
-                                       });
-
-    if (driverSelected == this->driverConfiguration.end()) {
-        std::cerr << Glib::ustring::compose(_("Driver %1 not found "), driverName) << std::endl;
+    auto selectedApp = (*userSelectedDriver)->findEquivalentApplication(*listedApp);
+    if (selectedApp == nullptr) {
+        std::cerr << Glib::ustring::compose(_("Application %1 not found "), listedApp->getName())
+                  << std::endl;
         return;
     }
 
-    this->currentDriver = &(*driverSelected);
+    if (selectedApp == this->currentApp) {
+        return;
+    }
 
-    this->drawApplicationOptions();
+    if (this->setCurrentApplication(*userSelectedDriver, selectedApp)) {
+        this->drawApplicationOptions();
+    }
 }
 
 void GUI::drawApplicationOptions() {
-    auto selectedAppOptions = this->currentApp->getOptions();
+    /* Only the visible application gets its values resolved */
+    auto selectedAppOptions = ConfigurationResolver::resolveApplicationOptions(
+            this->systemWideConfiguration, *(this->currentDriver), *(this->currentApp)
+    );
+
+    if (this->optionList && this->pOptionStack && this->pOptionListAction
+        && this->pOptionListAction->get_active()) {
+        this->optionList->populate(this->currentDriver->getSchema(), selectedAppOptions);
+        this->pOptionStack->set_visible_child("list");
+        return;
+    }
+
+    if (this->pOptionStack) {
+        this->pOptionStack->set_visible_child("widgets");
+    }
 
     /* Get the notebook itself */
     Gtk::Notebook *pNotebook;
@@ -262,13 +352,15 @@ void GUI::drawApplicationOptions() {
         pNotebook->remove_page(-1);
     }
 
-    /* Remove any previous defined comboBox */
-    this->currentComboBoxes.clear();
-    /* Remove any previous defined spinButton */
-    this->currentSpinButtons.clear();
+    /* Remove any previous defined comboBox and spinButton */
+    this->currentComboBoxes.assign(selectedAppOptions.size(), nullptr);
+    this->currentSpinButtons.assign(selectedAppOptions.size(), nullptr);
 
     pNotebook->set_visible(true);
 
+    /* The sections hold the options in the same order as the schema ordinals */
+    std::size_t ordinal = 0;
+
     /* Draw each section as a tab */
     for (auto &section : this->currentDriver->getSections()) {
         Gtk::Box *tabBox = Gtk::manage(new Gtk::Box);
@@ -281,19 +373,7 @@ void GUI::drawApplicationOptions() {
 
         /* Draw each field individually */
         for (auto &option : section.getOptions()) {
-            auto optionValue = std::find_if(selectedAppOptions.begin(), selectedAppOptions.end(),
-                                            [&option](ApplicationOption_ptr o) {
-                                                return option.getName() == o->getName();
-                                            });
-
-            if (optionValue == selectedAppOptions.end()) {
-                std::cerr << Glib::ustring::compose(
-                        _("Option %1 doesn't exist in application %2. Merge failed"),
-                        option.getName(),
-                        this->currentApp->getName()
-                ) << std::endl;
-                return;
-            }
+            const auto &optionValue = selectedAppOptions[ordinal];
 
             Gtk::Box *optionBox = Gtk::manage(new Gtk::Box);
             optionBox->set_visible(true);
@@ -304,12 +384,12 @@ void GUI::drawApplicationOptions() {
                 Gtk::Switch *optionSwitch = Gtk::manage(new Gtk::Switch);
                 optionSwitch->set_visible(true);
 
-                if ((*optionValue)->getValue() == "true") {
+                if (optionValue == "true") {
                     optionSwitch->set_active(true);
                 }
 
-                optionSwitch->property_active().signal_changed().connect(sigc::bind<Glib::ustring>(
-                        sigc::mem_fun(this, &GUI::onCheckboxChanged), option.getName()
+                optionSwitch->property_active().signal_changed().connect(sigc::bind<std::size_t>(
+                        sigc::mem_fun(this, &GUI::onCheckboxChanged), ordinal
                 ));
 
                 optionBox->pack_end(*optionSwitch, false, false);
@@ -319,12 +399,12 @@ void GUI::drawApplicationOptions() {
                 Gtk::Switch *optionSwitch = Gtk::manage(new Gtk::Switch);
                 optionSwitch->set_visible(true);
 
-                if ((*optionValue)->getValue() == "1") {
+                if (optionValue == "1") {
                     optionSwitch->set_active(true);
                 }
 
-                optionSwitch->property_active().signal_changed().connect(sigc::bind<Glib::ustring>(
-                        sigc::mem_fun(this, &GUI::onFakeCheckBoxChanged), option.getName()
+                optionSwitch->property_active().signal_changed().connect(sigc::bind<std::size_t>(
+                        sigc::mem_fun(this, &GUI::onFakeCheckBoxChanged), ordinal
                 ));
 
                 optionBox->pack_end(*optionSwitch, false, false);
@@ -337,17 +417,17 @@ void GUI::drawApplicationOptions() {
                 int counter = 0;
                 for (auto const &enumOption : option.getEnumValues()) {
                     optionCombo->append(enumOption.first);
-                    if (enumOption.second == (*optionValue)->getValue()) {
+                    if (enumOption.second == optionValue) {
                         optionCombo->set_active(counter);
                     }
                     counter++;
                 }
 
-                optionCombo->signal_changed().connect(sigc::bind<Glib::ustring>(
-                        sigc::mem_fun(this, &GUI::onComboboxChanged), option.getName()
+                optionCombo->signal_changed().connect(sigc::bind<std::size_t>(
+                        sigc::mem_fun(this, &GUI::onComboboxChanged), ordinal
                 ));
 
-                this->currentComboBoxes[option.getName()] = optionCombo;
+                this->currentComboBoxes[ordinal] = optionCombo;
 
                 optionBox->pack_end(*optionCombo, false, false);
             }
@@ -356,10 +436,20 @@ void GUI::drawApplicationOptions() {
                 Gtk::SpinButton *optionEntry = Gtk::manage(new Gtk::SpinButton);
                 optionEntry->set_visible(true);
 
-                auto currentValue = (*optionValue)->getValue();
+                /* Invalid values were already reported by the validator, show the driver default instead */
+                double currentValue = 0;
+                try {
+                    currentValue = std::stod(optionValue);
+                } catch (const std::exception &ex) {
+                    try {
+                        currentValue = std::stod(option.getDefaultValue());
+                    } catch (const std::exception &defaultEx) {
+                        currentValue = option.getValidValueStart();
+                    }
+                }
 
                 auto adjustment = Gtk::Adjustment::create(
-                        std::stof(currentValue),
+                        currentValue,
                         option.getValidValueStart(),
                         option.getValidValueEnd(),
                         1,
@@ -367,11 +457,11 @@ void GUI::drawApplicationOptions() {
                 );
 
                 optionEntry->set_adjustment(adjustment);
-                optionEntry->signal_changed().connect(sigc::bind<Glib::ustring>(
-                        sigc::mem_fun(this, &GUI::onNumberEntryChanged), option.getName()
+                optionEntry->signal_changed().connect(sigc::bind<std::size_t>(
+                        sigc::mem_fun(this, &GUI::onNumberEntryChanged), ordinal
                 ));
 
-                this->currentSpinButtons[option.getName()] = optionEntry;
+                this->currentSpinButtons[ordinal] = optionEntry;
 
                 optionBox->pack_end(*optionEntry, false, true);
             }
@@ -385,6 +475,7 @@ void GUI::drawApplicationOptions() {
             optionBox->pack_start(*label, false, true);
 
             tabBox->add(*optionBox);
+            ordinal++;
         }
 
 
@@ -396,66 +487,243 @@ void GUI::drawApplicationOptions() {
     }
 }
 
-void GUI::onCheckboxChanged(Glib::ustring optionName) {
-    auto eventSelectedAppOptions = this->currentApp->getOptions();
+Device_ptr GUI::findCurrentDevice() {
+    for (const auto &device : this->userDefinedConfiguration) {
+        if (device->hasApplication(this->currentApp)) {
+            return device;
+        }
+    }
+
+    return nullptr;
+}
+
+Glib::ustring GUI::getCurrentAppOptionValue(std::size_t ordinal) {
+    auto resolvedOptions = ConfigurationResolver::resolveApplicationOptions(
+            this->systemWideConfiguration, *(this->currentDriver), *(this->currentApp)
+    );
+
+    return resolvedOptions[ordinal];
+}
+
+const Glib::ustring &GUI::getCurrentOptionName(std::size_t ordinal) const {
+    return this->currentDriver->getSchema()->getOptions()[ordinal]->getName();
+}
+
+void GUI::setCurrentAppOption(const Glib::ustring &optionName, const Glib::ustring &value) {
+    auto currentDevice = this->findCurrentDevice();
+    if (currentDevice == nullptr) {
+        std::cerr << Glib::ustring::compose(_("Application %1 not found "), this->currentApp->getName())
+                  << std::endl;
+        return;
+    }
+
+    /* Never change the application in place, the previous snapshots still use it */
+    auto newApp = ConfigurationHistory::withOptionValue(this->currentApp, optionName, value);
+    auto newConfiguration = ConfigurationHistory::withApplicationReplaced(
+            this->userDefinedConfiguration, currentDevice, this->currentApp, newApp
+    );
+
+    /* Repeated changes of the same option (like dragging a spin button) are a single undo step */
+    Glib::ustring mergeKey = Glib::ustring::compose(
+            "%1/%2/%3/%4",
+            currentDevice->getDriver(),
+            currentDevice->getScreen(),
+            newApp->getName(),
+            optionName
+    );
+    this->history.commit(newConfiguration, mergeKey);
+
+    this->userDefinedConfiguration = this->history.getCurrent();
+    this->currentApp = newApp;
 
-    auto currentOption = std::find_if(eventSelectedAppOptions.begin(), eventSelectedAppOptions.end(),
-                                      [&optionName](ApplicationOption_ptr a) {
-                                          return a->getName() == optionName;
-                                      });
+    this->updateHistoryActions();
+    this->scheduleAutosave();
+}
 
-    if ((*currentOption)->getValue() == "true") {
-        (*currentOption)->setValue("false");
+void GUI::onCheckboxChanged(std::size_t ordinal) {
+    if (this->getCurrentAppOptionValue(ordinal) == "true") {
+        this->setCurrentAppOption(this->getCurrentOptionName(ordinal), "false");
     } else {
-        (*currentOption)->setValue("true");
+        this->setCurrentAppOption(this->getCurrentOptionName(ordinal), "true");
     }
 }
 
-void GUI::onFakeCheckBoxChanged(Glib::ustring optionName) {
-    auto eventSelectedAppOptions = this->currentApp->getOptions();
+void GUI::onFakeCheckBoxChanged(std::size_t ordinal) {
+    if (this->getCurrentAppOptionValue(ordinal) == "1") {
+        this->setCurrentAppOption(this->getCurrentOptionName(ordinal), "0");
+    } else {
+        this->setCurrentAppOption(this->getCurrentOptionName(ordinal), "1");
+    }
+}
 
-    auto currentOption = std::find_if(eventSelectedAppOptions.begin(), eventSelectedAppOptions.end(),
-                                      [&optionName](ApplicationOption_ptr a) {
-                                          return a->getName() == optionName;
-                                      });
+void GUI::onComboboxChanged(std::size_t ordinal) {
+    auto selectedOptionText = this->currentComboBoxes[ordinal]->get_active_text();
 
-    if ((*currentOption)->getValue() == "1") {
-        (*currentOption)->setValue("0");
-    } else {
-        (*currentOption)->setValue("1");
+    const auto &option = *(this->currentDriver->getSchema()->getOptions()[ordinal]);
+    for (const auto &enumValue : option.getEnumValues()) {
+        if (enumValue.first == selectedOptionText) {
+            this->setCurrentAppOption(option.getName(), enumValue.second);
+        }
     }
+
 }
 
-void GUI::onComboboxChanged(Glib::ustring optionName) {
-    auto eventSelectedAppOptions = this->currentApp->getOptions();
+void GUI::onNumberEntryChanged(std::size_t ordinal) {
+    auto enteredValue = this->currentSpinButtons[ordinal]->get_value();
+    Glib::ustring enteredValueStr(std::to_string((int) enteredValue));
+    this->setCurrentAppOption(this->getCurrentOptionName(ordinal), enteredValueStr);
+}
+
+void GUI::onUndoPressed() {
+    if (!this->history.canUndo()) {
+        return;
+    }
+
+    this->restoreSnapshot(this->history.undo());
+}
 
-    auto currentOption = std::find_if(eventSelectedAppOptions.begin(), eventSelectedAppOptions.end(),
-                                      [&optionName](ApplicationOption_ptr a) {
-                                          return a->getName() == optionName;
-                                      });
+void GUI::onRedoPressed() {
+    if (!this->history.canRedo()) {
+        return;
+    }
 
-    auto selectedOptionText = this->currentComboBoxes[optionName]->get_active_text();
+    this->restoreSnapshot(this->history.redo());
+}
 
-    auto enumValues = this->currentDriver->getEnumValuesForOption(optionName);
-    for (const auto &enumValue : enumValues) {
-        if (enumValue.first == selectedOptionText) {
-            (*currentOption)->setValue(enumValue.second);
+void GUI::restoreSnapshot(const std::list<Device_ptr> &snapshot) {
+    Glib::ustring driverName(this->currentDriver->getDriver());
+    int screen = this->currentDriver->getScreen();
+    auto previousApp = this->currentApp;
+
+    this->userDefinedConfiguration = snapshot;
+    this->updateHistoryActions();
+    this->scheduleAutosave();
+
+    /* Any application may have been added or removed, the list only holds rows so this is cheap */
+    this->drawApplicationList();
+
+    /* Keep the same application selected, if it still exists in the restored configuration */
+    for (const auto &device : this->userDefinedConfiguration) {
+        if (device->getDriver() != driverName || device->getScreen() != screen) {
+            continue;
+        }
+
+        auto restoredApp = device->findEquivalentApplication(*previousApp);
+        if (restoredApp != nullptr) {
+            this->setCurrentApplication(device, restoredApp);
         }
     }
 
+    this->drawApplicationOptions();
 }
 
-void GUI::onNumberEntryChanged(Glib::ustring optionName) {
-    auto eventSelectedAppOptions = this->currentApp->getOptions();
+void GUI::scheduleAutosave() {
+    if (this->autosaveDelay == 0) {
+        return;
+    }
+
+    this->autosaveTimeout.disconnect();
+    this->autosaveTimeout = Glib::signal_timeout().connect(
+            sigc::mem_fun(this, &GUI::onAutosaveTimeout), this->autosaveDelay
+    );
+}
 
-    auto currentOption = std::find_if(eventSelectedAppOptions.begin(), eventSelectedAppOptions.end(),
-                                      [&optionName](ApplicationOption_ptr a) {
-                                          return a->getName() == optionName;
-                                      });
+bool GUI::onAutosaveTimeout() {
+    this->onSavePressed();
 
-    auto enteredValue = this->currentSpinButtons[optionName]->get_value();
-    Glib::ustring enteredValueStr(std::to_string((int) enteredValue));
-    (*currentOption)->setValue(enteredValueStr);
+    /* Run only once, the next change schedules it again */
+    return false;
+}
+
+void GUI::onGPUsChanged() {
+    /* Only sysfs is read here, the device nodes of the GPUs already known are left alone */
+    DRIQuery driQuery;
+    auto gpus = driQuery.enumerateDRIDevices();
+
+    for (const auto &gpu : this->availableGPUs) {
+        if (gpus.find(gpu.first) == gpus.end()) {
+            std::cout << Glib::ustring::compose(_("GPU %1 removed"), gpu.first) << std::endl;
+        }
+    }
+
+    for (const auto &gpu : gpus) {
+        if (this->availableGPUs.find(gpu.first) == this->availableGPUs.end()) {
+            std::cout << Glib::ustring::compose(_("GPU %1 (%2) added"), gpu.first, gpu.second->getDriverName())
+                      << std::endl;
+            this->addDriverForDevice(driQuery, gpu.first);
+        }
+    }
+
+    /*
+     * The options of a removed GPU stay editable, as its driver may still be used by another device
+     * and the user-defined configuration for it must not be lost
+     */
+    this->availableGPUs = gpus;
+}
+
+void GUI::addDriverForDevice(DRIQuery &driQuery, const Glib::ustring &busId) {
+    DriverConfiguration newDriver;
+    if (!driQuery.queryDeviceConfiguration(busId, this->locale, newDriver)) {
+        return;
+    }
+
+    /* Devices using a driver already loaded share its options */
+    auto driverExists = std::find_if(this->driverConfiguration.begin(), this->driverConfiguration.end(),
+                                     [&newDriver](const DriverConfiguration &d) {
+                                         return d.getDriver() == newDriver.getDriver()
+                                                && d.getScreen() == newDriver.getScreen();
+                                     });
+    if (driverExists != this->driverConfiguration.end()) {
+        return;
+    }
+
+    std::list<DriverConfiguration> newDrivers;
+    newDrivers.emplace_back(newDriver);
+
+    /* The user-defined devices of this driver were dropped at startup, read them again from the file */
+    ConfigurationLoader configurationLoader;
+    std::list<Device_ptr> newDevices;
+    for (const auto &device : configurationLoader.loadUserDefinedConfiguration()) {
+        if (device->getDriver() == newDriver.getDriver() && device->getScreen() == newDriver.getScreen()) {
+            newDevices.emplace_back(device);
+        }
+    }
+
+    ConfigurationResolver::filterDriverUnsupportedOptions(newDrivers, newDevices);
+    ConfigurationResolver::mergeOptionsForDisplay(this->systemWideConfiguration, newDrivers, newDevices);
+
+    /* Nothing else changes: the current driver pointer stays valid as the list only grows */
+    this->driverConfiguration.emplace_back(newDriver);
+
+    for (const auto &device : newDevices) {
+        device->sortApplications();
+        this->history.addDevice(device);
+
+        for (const auto &application : device->getApplications()) {
+            this->applicationList->addApplication(device, application);
+        }
+    }
+
+    this->userDefinedConfiguration = this->history.getCurrent();
+
+    /* Started without any usable GPU, show the first driver now */
+    if (this->currentApp == nullptr) {
+        this->drawApplicationList();
+
+        if (this->currentApp != nullptr) {
+            this->drawApplicationOptions();
+        }
+    }
+}
+
+void GUI::updateHistoryActions() {
+    if (this->pUndoAction) {
+        this->pUndoAction->set_sensitive(this->history.canUndo());
+    }
+
+    if (this->pRedoAction) {
+        this->pRedoAction->set_sensitive(this->history.canRedo());
+    }
 }
 
 void GUI::setupAboutDialog() {
@@ -497,26 +765,52 @@ void GUI::setupAboutDialog() {
 }
 
 void GUI::onRemoveApplicationPressed() {
-    if (this->currentApp->getExecutable().empty()) {
+    if (this->currentApp->isDefault()) {
         Gtk::MessageDialog dialog(*(this->pWindow), _("The default application cannot be removed."));
         dialog.set_secondary_text(_("The driver needs a default configuration."));
         dialog.run();
         return;
     }
 
+    auto newConfiguration = this->userDefinedConfiguration;
     for (auto &device : this->userDefinedConfiguration) {
         if (device->getDriver() == this->currentDriver->getDriver()) {
-            device->getApplications().remove_if([this](const Application_ptr &app) {
-                return app->getExecutable() == this->currentApp->getExecutable();
-            });
+            /* The other screens of the driver have their own copy of the application */
+            auto app = device->hasApplication(this->currentApp)
+                       ? this->currentApp
+                       : device->findEquivalentApplication(*this->currentApp);
+            if (app != nullptr) {
+                newConfiguration = ConfigurationHistory::withApplicationReplaced(
+                        newConfiguration, device, app, nullptr
+                );
+                this->applicationList->removeApplication(device, *app);
+            }
         }
     }
 
+    this->history.commit(newConfiguration, "");
+    this->userDefinedConfiguration = this->history.getCurrent();
+    this->updateHistoryActions();
+    this->scheduleAutosave();
+
     Gtk::MessageDialog dialog(*(this->pWindow), _("Application removed successfully."));
     dialog.set_secondary_text(_("The application has been removed."));
     dialog.run();
 
-    this->drawApplicationSelectionMenu();
+    /* Show the default application of the same driver */
+    for (const auto &device : this->userDefinedConfiguration) {
+        if (device->getDriver() != this->currentDriver->getDriver()
+            || device->getScreen() != this->currentDriver->getScreen()) {
+            continue;
+        }
+
+        for (const auto &app : device->getApplications()) {
+            if (app->isDefault()) {
+                this->setCurrentApplication(device, app);
+            }
+        }
+    }
+
     this->drawApplicationOptions();
 }
 
@@ -585,7 +879,7 @@ void GUI::onAddApplicationPressed() {
     int result = addAppDialog.run();
 
     Gtk::MessageDialog dialog(*(this->pWindow), _("Application successfully added."));
-    dialog.set_secondary_text(_("The application was successfully added. Reloading default app options."));
+    dialog.set_secondary_text(_("The application was successfully added."));
 
     switch (result) {
         case Gtk::RESPONSE_CLOSE:
@@ -614,9 +908,37 @@ void GUI::onAddApplicationPressed() {
             newApplication->setName(entryAppName->get_text());
             newApplication->setExecutable(entryAppExecutable->get_text());
 
-            for (auto &userConfig : this->userDefinedConfiguration) {
-                if (userConfig->getDriver() == comboAppDriver->get_active_text()) {
-                    userConfig->addApplication(newApplication);
+            {
+                auto newConfiguration = this->userDefinedConfiguration;
+                for (auto &userConfig : this->userDefinedConfiguration) {
+                    if (userConfig->getDriver() == comboAppDriver->get_active_text()) {
+                        newConfiguration = ConfigurationHistory::withApplicationAdded(
+                                newConfiguration, userConfig, newApplication
+                        );
+                    }
+                }
+
+                this->history.commit(newConfiguration, "");
+                this->userDefinedConfiguration = this->history.getCurrent();
+                this->updateHistoryActions();
+                this->scheduleAutosave();
+            }
+
+            /* Only the new rows are added to the list */
+            {
+                Device_ptr firstDevice = nullptr;
+                for (const auto &device : this->userDefinedConfiguration) {
+                    if (device->getDriver() == comboAppDriver->get_active_text()) {
+                        this->applicationList->addApplication(device, newApplication);
+
+                        if (firstDevice == nullptr) {
+                            firstDevice = device;
+                        }
+                    }
+                }
+
+                if (firstDevice != nullptr) {
+                    this->setCurrentApplication(firstDevice, newApplication);
                 }
             }
 
@@ -624,7 +946,6 @@ void GUI::onAddApplicationPressed() {
 
             dialog.run();
 
-            this->drawApplicationSelectionMenu();
             this->drawApplicationOptions();
 
             break;
@@ -6,6 +6,11 @@
 #include "Device.h"
 #include "DriverConfiguration.h"
 #include "ConfigurationLoader.h"
+#include "ConfigurationHistory.h"
+#include "ConfigurationSaver.h"
+#include "ApplicationList.h"
+#include "OptionList.h"
+#include "GPUMonitor.h"
 
 class GUI {
 private:
@@ -14,6 +19,12 @@ private:
     Gtk::AboutDialog aboutDialog;
     Gtk::MenuItem *pMenuAddApplication;
     Gtk::MenuItem *pMenuRemoveApplication;
+    Gtk::ImageMenuItem *pUndoAction;
+    Gtk::ImageMenuItem *pRedoAction;
+    Gtk::CheckMenuItem *pOptionListAction;
+    Gtk::Stack *pOptionStack;
+    std::unique_ptr<ApplicationList> applicationList;
+    std::unique_ptr<OptionList> optionList;
 
     /* State-related */
     Device_ptr systemWideConfiguration;
@@ -22,8 +33,14 @@ private:
     std::map<Glib::ustring, GPUInfo_ptr> availableGPUs;
     Application_ptr currentApp;
     DriverConfiguration * currentDriver;
-    std::map<Glib::ustring, Gtk::ComboBoxText *> currentComboBoxes;
-    std::map<Glib::ustring, Gtk::SpinButton *> currentSpinButtons;
+    /* Indexed by the option ordinal in the current driver schema */
+    std::vector<Gtk::ComboBoxText *> currentComboBoxes;
+    std::vector<Gtk::SpinButton *> currentSpinButtons;
+    ConfigurationHistory history;
+    ConfigurationSaver saver;
+    unsigned int autosaveDelay;
+    sigc::connection autosaveTimeout;
+    std::unique_ptr<GPUMonitor> gpuMonitor;
 
     /* Helpers */
     Glib::RefPtr<Gtk::Builder> gladeBuilder;
@@ -31,37 +48,75 @@ private:
 
     void setupLocale();
 
-    void drawApplicationSelectionMenu();
+    void drawApplicationList();
+
+    /* Make the application the current one and select its row, returns false if its driver isn't loaded */
+    bool setCurrentApplication(const Device_ptr &device, const Application_ptr &application);
 
     void drawApplicationOptions();
 
     void setupAboutDialog();
 
+    /* The user-defined device that has the current application */
+    Device_ptr findCurrentDevice();
+
+    /* @param ordinal Position of the option in the current driver schema */
+    Glib::ustring getCurrentAppOptionValue(std::size_t ordinal);
+
+    const Glib::ustring &getCurrentOptionName(std::size_t ordinal) const;
+
+    /* Change an option of the current application, recording it in the history */
+    void setCurrentAppOption(const Glib::ustring &optionName, const Glib::ustring &value);
+
+    void restoreSnapshot(const std::list<Device_ptr> &snapshot);
+
+    void updateHistoryActions();
+
+    /* Restart the autosave idle timer, so a burst of changes ends in a single save */
+    void scheduleAutosave();
+
+    bool onAutosaveTimeout();
+
+    /* Query the driver of a GPU plugged in after startup, adding it to the model if it's a new driver */
+    void addDriverForDevice(DRIQuery &driQuery, const Glib::ustring &busId);
+
 public:
-    GUI();
+    /* @param autosaveDelay Idle time in milliseconds before the changes are saved, 0 to disable autosave */
+    explicit GUI(unsigned int autosaveDelay = 0);
 
     virtual ~GUI();
 
     Gtk::Window *getWindowPointer();
 
+    /* Memory used by the loaded model and every undo snapshot, see MemoryReport */
+    std::string describeMemoryUsage() const;
+
     /* Signal Handlers */
     void onQuitPressed();
 
     void onSavePressed();
 
-    void onApplicationSelected(Glib::ustring, Glib::ustring);
+    void onSaveFinished(const ConfigurationSaver::Result &result);
+
+    void onApplicationSelected(const Glib::ustring &driverName, int screen, const Application_ptr &listedApp);
 
-    void onCheckboxChanged(Glib::ustring);
+    void onCheckboxChanged(std::size_t);
 
-    void onFakeCheckBoxChanged(Glib::ustring);
+    void onFakeCheckBoxChanged(std::size_t);
 
-    void onComboboxChanged(Glib::ustring);
+    void onComboboxChanged(std::size_t);
 
-    void onNumberEntryChanged(Glib::ustring);
+    void onNumberEntryChanged(std::size_t);
 
     void onRemoveApplicationPressed();
 
     void onAddApplicationPressed();
+
+    void onUndoPressed();
+
+    void onRedoPressed();
+
+    void onGPUsChanged();
 };
 
 #endif
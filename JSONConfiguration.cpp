@@ -0,0 +1,542 @@
+#include "JSONConfiguration.h"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <glibmm/i18n.h>
+#include "Counters.h"
+
+namespace {
+    class JSONReader {
+    private:
+        const char *start;
+        const char *position;
+        const char *end;
+
+    public:
+        explicit JSONReader(const std::string &json)
+                : start(json.data()), position(json.data()), end(json.data() + json.size()) {}
+
+        [[noreturn]] void fail(const char *expected) const {
+            throw std::runtime_error(Glib::ustring::compose(
+                    _("expected %1 at offset %2"), expected, position - start
+            ));
+        }
+
+        void skipWhitespace() {
+            while (position < end && (*position == ' ' || *position == '\n' || *position == '\r' || *position == '\t')) {
+                position++;
+            }
+        }
+
+        bool atEnd() {
+            skipWhitespace();
+            return position == end;
+        }
+
+        /* Consume the character if it is the next one */
+        bool consume(char character) {
+            skipWhitespace();
+            if (position < end && *position == character) {
+                position++;
+                return true;
+            }
+
+            return false;
+        }
+
+        void expect(char character) {
+            if (!consume(character)) {
+                const char expected[] = {'\'', character, '\'', '\0'};
+                fail(expected);
+            }
+        }
+
+        void readString(std::string &output) {
+            expect('"');
+            output.clear();
+
+            while (true) {
+                /* Copy everything up to the next quote, backslash or control character at once */
+                const char *runStart = position;
+                while (position < end && *position != '"' && *position != '\\'
+                       && static_cast<unsigned char>(*position) >= 0x20) {
+                    position++;
+                }
+                output.append(runStart, position);
+
+                if (position == end || static_cast<unsigned char>(*position) < 0x20) {
+                    fail("'\"'");
+                }
+
+                if (*position++ == '"') {
+                    return;
+                }
+
+                if (position == end) {
+                    fail("an escape sequence");
+                }
+
+                switch (*position++) {
+                    case '"':
+                        output.push_back('"');
+                        break;
+                    case '\\':
+                        output.push_back('\\');
+                        break;
+                    case '/':
+                        output.push_back('/');
+                        break;
+                    case 'b':
+                        output.push_back('\b');
+                        break;
+                    case 'f':
+                        output.push_back('\f');
+                        break;
+                    case 'n':
+                        output.push_back('\n');
+                        break;
+                    case 'r':
+                        output.push_back('\r');
+                        break;
+                    case 't':
+                        output.push_back('\t');
+                        break;
+                    case 'u':
+                        appendCodePoint(output, readCodePoint());
+                        break;
+                    default:
+                        position--;
+                        fail("an escape sequence");
+                }
+            }
+        }
+
+        int readInteger() {
+            skipWhitespace();
+            bool negative = position < end && *position == '-';
+            if (negative) {
+                position++;
+            }
+
+            if (position == end || *position < '0' || *position > '9') {
+                fail("a number");
+            }
+
+            long value = 0;
+            while (position < end && *position >= '0' && *position <= '9') {
+                value = value * 10 + (*position++ - '0');
+                if (value > 0x7fffffffL) {
+                    fail("a smaller number");
+                }
+            }
+
+            return static_cast<int>(negative ? -value : value);
+        }
+
+        bool readBoolean() {
+            skipWhitespace();
+            if (matchLiteral("true")) {
+                return true;
+            }
+            if (matchLiteral("false")) {
+                return false;
+            }
+
+            fail("true or false");
+        }
+
+        /* Skip a value of any type, used for keys we don't know */
+        void skipValue() {
+            skipWhitespace();
+            if (position == end) {
+                fail("a value");
+            }
+
+            std::string ignored;
+            switch (*position) {
+                case '"':
+                    readString(ignored);
+                    return;
+
+                case '{':
+                    position++;
+                    if (consume('}')) {
+                        return;
+                    }
+                    do {
+                        readString(ignored);
+                        expect(':');
+                        skipValue();
+                    } while (consume(','));
+                    expect('}');
+                    return;
+
+                case '[':
+                    position++;
+                    if (consume(']')) {
+                        return;
+                    }
+                    do {
+                        skipValue();
+                    } while (consume(','));
+                    expect(']');
+                    return;
+
+                default:
+                    if (matchLiteral("true") || matchLiteral("false") || matchLiteral("null")) {
+                        return;
+                    }
+
+                    const char *numberStart = position;
+                    while (position < end && std::strchr("+-0123456789.eE", *position) != nullptr && *position != '\0') {
+                        position++;
+                    }
+                    if (position == numberStart) {
+                        fail("a value");
+                    }
+            }
+        }
+
+    private:
+        bool matchLiteral(const char *literal) {
+            auto length = std::strlen(literal);
+            if (static_cast<std::size_t>(end - position) >= length && std::memcmp(position, literal, length) == 0) {
+                position += length;
+                return true;
+            }
+
+            return false;
+        }
+
+        unsigned int readHex4() {
+            if (end - position < 4) {
+                fail("four hex digits");
+            }
+
+            unsigned int value = 0;
+            for (int i = 0; i < 4; i++) {
+                char digit = *position++;
+                value <<= 4;
+                if (digit >= '0' && digit <= '9') {
+                    value |= digit - '0';
+                } else if (digit >= 'a' && digit <= 'f') {
+                    value |= digit - 'a' + 10;
+                } else if (digit >= 'A' && digit <= 'F') {
+                    value |= digit - 'A' + 10;
+                } else {
+                    fail("four hex digits");
+                }
+            }
+
+            return value;
+        }
+
+        unsigned int readCodePoint() {
+            unsigned int codePoint = readHex4();
+
+            /* Characters outside the BMP come as a surrogate pair */
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                if (end - position < 2 || position[0] != '\\' || position[1] != 'u') {
+                    fail("a low surrogate");
+                }
+                position += 2;
+
+                unsigned int low = readHex4();
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    fail("a low surrogate");
+                }
+
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+            } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                fail("a high surrogate");
+            }
+
+            return codePoint;
+        }
+
+        static void appendCodePoint(std::string &output, unsigned int codePoint) {
+            if (codePoint < 0x80) {
+                output.push_back(static_cast<char>(codePoint));
+            } else if (codePoint < 0x800) {
+                output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            } else if (codePoint < 0x10000) {
+                output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            } else {
+                output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+    };
+
+    /*
+     * Call the handler for every member of an object, with the reader positioned on the value
+     * The key buffer is reused by nested objects, so the handler must not use the key after reading the value.
+     */
+    template<typename Handler>
+    void readObject(JSONReader &reader, std::string &key, Handler handler) {
+        reader.expect('{');
+        if (reader.consume('}')) {
+            return;
+        }
+
+        do {
+            reader.readString(key);
+            reader.expect(':');
+            handler(key);
+        } while (reader.consume(','));
+
+        reader.expect('}');
+    }
+
+    template<typename Handler>
+    void readArray(JSONReader &reader, Handler handler) {
+        reader.expect('[');
+        if (reader.consume(']')) {
+            return;
+        }
+
+        do {
+            handler();
+        } while (reader.consume(','));
+
+        reader.expect(']');
+    }
+
+    ApplicationOption_ptr readOption(JSONReader &reader, std::string &key, std::string &value,
+                                     uint64_t &allocatedOptions) {
+        auto option = std::make_shared<ApplicationOption>();
+        allocatedOptions++;
+
+        readObject(reader, key, [&](const std::string &name) {
+            if (name == "name") {
+                reader.readString(value);
+                option->setName(value);
+            } else if (name == "value") {
+                reader.readString(value);
+                option->setValue(value);
+            } else {
+                reader.skipValue();
+            }
+        });
+
+        return option;
+    }
+
+    Application_ptr readApplication(JSONReader &reader, std::string &key, std::string &value,
+                                    uint64_t &allocatedOptions) {
+        auto application = std::make_shared<Application>();
+
+        readObject(reader, key, [&](const std::string &name) {
+            if (name == "options") {
+                readArray(reader, [&]() {
+                    application->addOption(readOption(reader, key, value, allocatedOptions));
+                });
+                return;
+            }
+
+            if (name == "engine") {
+                application->setEngine(reader.readBoolean());
+                return;
+            }
+
+            /* Every other attribute is a string */
+            void (Application::*setter)(Glib::ustring) = nullptr;
+            if (name == "name") {
+                setter = &Application::setName;
+            } else if (name == "executable") {
+                setter = &Application::setExecutable;
+            } else if (name == "executable_regexp") {
+                setter = &Application::setExecutableRegexp;
+            } else if (name == "sha1") {
+                setter = &Application::setSha1;
+            } else if (name == "application_name_match") {
+                setter = &Application::setApplicationNameMatch;
+            } else if (name == "application_versions") {
+                setter = &Application::setApplicationVersions;
+            } else if (name == "engine_name_match") {
+                setter = &Application::setEngineNameMatch;
+            } else if (name == "engine_versions") {
+                setter = &Application::setEngineVersions;
+            }
+
+            if (setter == nullptr) {
+                reader.skipValue();
+                return;
+            }
+
+            reader.readString(value);
+            (application.get()->*setter)(value);
+        });
+
+        return application;
+    }
+
+    Device_ptr readDevice(JSONReader &reader, std::string &key, std::string &value, uint64_t &allocatedOptions) {
+        auto device = std::make_shared<Device>();
+
+        readObject(reader, key, [&](const std::string &name) {
+            if (name == "driver") {
+                reader.readString(value);
+                device->setDriver(value);
+            } else if (name == "screen") {
+                device->setScreen(reader.readInteger());
+            } else if (name == "applications") {
+                /* Applications and engines must keep the document order, as later ones take precedence */
+                readArray(reader, [&]() {
+                    device->addApplication(readApplication(reader, key, value, allocatedOptions));
+                });
+            } else {
+                reader.skipValue();
+            }
+        });
+
+        return device;
+    }
+
+    void appendString(std::string &output, const Glib::ustring &value) {
+        static const char hexDigits[] = "0123456789abcdef";
+        const auto &raw = value.raw();
+        std::size_t runStart = 0;
+
+        output.push_back('"');
+
+        for (std::size_t i = 0; i < raw.length(); i++) {
+            auto character = static_cast<unsigned char>(raw[i]);
+            if (character >= 0x20 && character != '"' && character != '\\') {
+                continue;
+            }
+
+            output.append(raw, runStart, i - runStart);
+            runStart = i + 1;
+
+            switch (character) {
+                case '"':
+                    output.append("\\\"");
+                    break;
+                case '\\':
+                    output.append("\\\\");
+                    break;
+                case '\n':
+                    output.append("\\n");
+                    break;
+                case '\t':
+                    output.append("\\t");
+                    break;
+                default:
+                    output.append("\\u00");
+                    output.push_back(hexDigits[character >> 4]);
+                    output.push_back(hexDigits[character & 0xF]);
+            }
+        }
+
+        output.append(raw, runStart, std::string::npos);
+        output.push_back('"');
+    }
+
+    void appendMember(std::string &output, const char *name, const Glib::ustring &value) {
+        if (value.empty()) {
+            return;
+        }
+
+        output.append(", \"");
+        output.append(name);
+        output.append("\": ");
+        appendString(output, value);
+    }
+}
+
+std::list<Device_ptr> JSONConfiguration::parseDevices(const std::string &json, Glib::ustring *error) {
+    std::list<Device_ptr> deviceList;
+    /* Counted locally and added once, as several documents may be parsed at the same time */
+    uint64_t allocatedOptions = 0;
+
+    try {
+        JSONReader reader(json);
+        /* Shared by every level, so parsing allocates little more than the model itself */
+        std::string key;
+        std::string value;
+
+        readArray(reader, [&]() {
+            deviceList.emplace_back(readDevice(reader, key, value, allocatedOptions));
+        });
+
+        if (!reader.atEnd()) {
+            reader.fail(_("the end of the file"));
+        }
+    } catch (const std::exception &ex) {
+        auto message = Glib::ustring::compose(_("Invalid JSON configuration: %1"), ex.what());
+        if (error != nullptr) {
+            *error = message;
+        } else {
+            std::cerr << message << std::endl;
+        }
+        deviceList.clear();
+    }
+
+    Counters::add(Counters::Counter::OPTIONS_ALLOCATED, allocatedOptions);
+
+    return deviceList;
+}
+
+std::string JSONConfiguration::generateRawJson(const std::list<Device_ptr> &devices) {
+    std::string output("[");
+    bool firstDevice = true;
+
+    for (const auto &device : devices) {
+        output.append(firstDevice ? "\n" : ",\n");
+        firstDevice = false;
+
+        output.append("  {\"driver\": ");
+        appendString(output, device->getDriver());
+        output.append(", \"screen\": ");
+        output.append(std::to_string(device->getScreen()));
+        output.append(", \"applications\": [");
+
+        bool firstApplication = true;
+        for (const auto &app : device->getApplications()) {
+            output.append(firstApplication ? "\n" : ",\n");
+            firstApplication = false;
+
+            output.append("    {\"name\": ");
+            appendString(output, app->getName());
+            if (app->isEngine()) {
+                output.append(", \"engine\": true");
+            }
+            appendMember(output, "executable", app->getExecutable());
+            appendMember(output, "executable_regexp", app->getExecutableRegexp());
+            appendMember(output, "sha1", app->getSha1());
+            appendMember(output, "application_name_match", app->getApplicationNameMatch());
+            appendMember(output, "application_versions", app->getApplicationVersions());
+            appendMember(output, "engine_name_match", app->getEngineNameMatch());
+            appendMember(output, "engine_versions", app->getEngineVersions());
+            output.append(", \"options\": [");
+
+            bool firstOption = true;
+            for (const auto &option : app->getOptions()) {
+                output.append(firstOption ? "\n" : ",\n");
+                firstOption = false;
+
+                output.append("      {\"name\": ");
+                appendString(output, option->getName());
+                output.append(", \"value\": ");
+                appendString(output, option->getValue());
+                output.append("}");
+            }
+
+            output.append(firstOption ? "]}" : "\n    ]}");
+        }
+
+        output.append(firstApplication ? "]}" : "\n  ]}");
+    }
+
+    output.append(firstDevice ? "]\n" : "\n]\n");
+    Counters::add(Counters::Counter::BYTES_WRITTEN, output.size());
+
+    return output;
+}
@@ -0,0 +1,32 @@
+#ifndef ADRICONF_JSONCONFIGURATION_H
+#define ADRICONF_JSONCONFIGURATION_H
+
+#include <list>
+#include <string>
+#include <glibmm/ustring.h>
+#include "Device.h"
+
+/**
+ * JSON form of the drirc devices, for tools that don't speak XML
+ * It holds exactly what the XML holds, so both convert to each other without losing anything:
+ *   [{"driver": "radeonsi", "screen": 0, "applications": [
+ *       {"name": "Game", "executable": "game", "options": [{"name": "vblank_mode", "value": "0"}]},
+ *       {"name": "Engine", "engine": true, "engine_name_match": "UnrealEngine", "options": []}
+ *   ]}]
+ * Application attributes use the drirc names and are left out when empty. Options are a list, not an object,
+ * to keep their order and any repeated option.
+ */
+namespace JSONConfiguration {
+    /**
+     * Build the devices in a single pass over the text, without an intermediate document
+     * Unknown keys are skipped, so newer files can still be read.
+     * @param json
+     * @param error When given, receives the parse error instead of logging it
+     * @return The devices, or an empty list when the text isn't valid
+     */
+    std::list<Device_ptr> parseDevices(const std::string &json, Glib::ustring *error = nullptr);
+
+    std::string generateRawJson(const std::list<Device_ptr> &devices);
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "CommandLine.h"
+
+#include <iostream>
+#include <string>
+#include "ConfigurationLoader.h"
+#include "JSONConfiguration.h"
+#include "Parser.h"
+#include "Writer.h"
+
+int CommandLine::runToJSON(int argc, char *argv[]) {
+    std::list<Device_ptr> devices;
+    Glib::ustring error;
+
+    if (argc == 2) {
+        ConfigurationLoader configurationLoader;
+        devices = configurationLoader.loadUserDefinedConfiguration(&error);
+    } else {
+        std::string contents;
+        if (!readInput(argc, argv, contents)) {
+            return 1;
+        }
+
+        Glib::ustring xml(contents);
+        devices = Parser::parseDevices(xml, &error);
+    }
+
+    if (!error.empty()) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    std::cout << JSONConfiguration::generateRawJson(devices);
+
+    return 0;
+}
+
+int CommandLine::runFromJSON(int argc, char *argv[]) {
+    std::string json;
+    if (!readInput(argc, argv, json)) {
+        return 1;
+    }
+
+    Glib::ustring error;
+    auto devices = JSONConfiguration::parseDevices(json, &error);
+    if (!error.empty()) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    std::cout << Writer::generateRawXml(devices) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "LaunchIndex.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <regex.h>
+
+namespace {
+    /* Split a line on tabs, without copying the fields */
+    std::vector<std::pair<const char *, std::size_t>> splitFields(const char *line, std::size_t length) {
+        std::vector<std::pair<const char *, std::size_t>> fields;
+        std::size_t start = 0;
+
+        for (std::size_t i = 0; i <= length; i++) {
+            if (i == length || line[i] == '\t') {
+                fields.emplace_back(line + start, i - start);
+                start = i + 1;
+            }
+        }
+
+        return fields;
+    }
+
+    bool regexpMatches(const std::string &expression, const std::string &executable) {
+        regex_t compiled;
+
+        /* Mesa ignores an invalid expression, applying the application anyway */
+        if (regcomp(&compiled, expression.c_str(), REG_EXTENDED | REG_NOSUB) != 0) {
+            return true;
+        }
+
+        bool matches = regexec(&compiled, executable.c_str(), 0, nullptr, 0) == 0;
+        regfree(&compiled);
+
+        return matches;
+    }
+}
+
+std::string LaunchIndex::getDefaultPath() {
+    const char *cacheHome = std::getenv("XDG_CACHE_HOME");
+    if (cacheHome != nullptr && cacheHome[0] != '\0') {
+        return std::string(cacheHome) + "/adriconf/launch-index";
+    }
+
+    const char *userHome = std::getenv("HOME");
+    return std::string(userHome != nullptr ? userHome : "") + "/.cache/adriconf/launch-index";
+}
+
+bool LaunchIndex::readTarget(const std::string &path, std::string &driver, int &screen) {
+    std::ifstream input(path);
+    std::string header;
+
+    if (!std::getline(input, header)) {
+        return false;
+    }
+
+    auto fields = splitFields(header.c_str(), header.length());
+    if (fields.size() != 3 || std::string(fields[0].first, fields[0].second) != LAUNCH_INDEX_MAGIC) {
+        return false;
+    }
+
+    driver.assign(fields[1].first, fields[1].second);
+    screen = std::atoi(std::string(fields[2].first, fields[2].second).c_str());
+
+    return true;
+}
+
+LaunchIndex::Overrides LaunchIndex::lookup(const std::string &index, const std::string &executable) {
+    Overrides overrides;
+    bool headerRead = false;
+    bool applicationMatches = false;
+    std::size_t lineStart = 0;
+
+    while (lineStart < index.length()) {
+        auto lineEnd = index.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = index.length();
+        }
+
+        auto fields = splitFields(index.c_str() + lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        if (!headerRead) {
+            /* A file from another version is ignored entirely */
+            if (std::string(fields[0].first, fields[0].second) != LAUNCH_INDEX_MAGIC) {
+                return overrides;
+            }
+
+            headerRead = true;
+            continue;
+        }
+
+        if (fields.size() != 3 || fields[0].second != 1) {
+            continue;
+        }
+
+        if (fields[0].first[0] == 'A') {
+            std::string applicationExecutable(fields[1].first, fields[1].second);
+            std::string applicationRegexp(fields[2].first, fields[2].second);
+
+            /* The exact name is checked first, so most applications never compile their expression */
+            applicationMatches = (applicationExecutable.empty() || applicationExecutable == executable)
+                                 && (applicationRegexp.empty() || regexpMatches(applicationRegexp, executable));
+            continue;
+        }
+
+        if (fields[0].first[0] != 'O' || !applicationMatches) {
+            continue;
+        }
+
+        std::string name(fields[1].first, fields[1].second);
+        std::string value(fields[2].first, fields[2].second);
+
+        bool replaced = false;
+        for (auto &override : overrides) {
+            if (override.first == name) {
+                override.second = value;
+                replaced = true;
+                break;
+            }
+        }
+
+        if (!replaced) {
+            overrides.emplace_back(name, value);
+        }
+    }
+
+    return overrides;
+}
@@ -0,0 +1,43 @@
+#ifndef ADRICONF_LAUNCHINDEX_H
+#define ADRICONF_LAUNCHINDEX_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#define LAUNCH_INDEX_MAGIC "adriconf-launch-index 1"
+
+/**
+ * Precompiled option overrides read by adriconf-run on every launch
+ * This only depends on the C and C++ standard libraries, so the launcher doesn't load glib or gtk.
+ *
+ * Text format, the fields are separated by tabs:
+ *   adriconf-launch-index 1 <driver> <screen>
+ *   A <executable> <executable regexp>
+ *   O <option> <value>
+ * Every "A" line is followed by the options of that application. Empty executable and regexp
+ * fields match every process. The applications are written in resolution order, so later ones win.
+ */
+namespace LaunchIndex {
+    typedef std::vector<std::pair<std::string, std::string>> Overrides;
+
+    /* $XDG_CACHE_HOME/adriconf/launch-index, or ~/.cache/adriconf/launch-index */
+    std::string getDefaultPath();
+
+    /**
+     * Read the driver and screen an index was built for
+     * @return false if the file doesn't exist or isn't an index
+     */
+    bool readTarget(const std::string &path, std::string &driver, int &screen);
+
+    /**
+     * Resolve the overrides of an executable
+     * Regular expressions use the POSIX extended syntax, same as Mesa.
+     * @param index The contents of the index file
+     * @param executable The executable name, without its directory
+     * @return The final options in the order they first appeared
+     */
+    Overrides lookup(const std::string &index, const std::string &executable);
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "LaunchIndexBuilder.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <glib.h>
+#include <glibmm/i18n.h>
+#include "EffectiveConfiguration.h"
+#include "LaunchIndex.h"
+
+namespace {
+    bool hasSeparator(const Glib::ustring &field) {
+        return field.raw().find_first_of("\t\n") != std::string::npos;
+    }
+
+    /* True if the rules of the application only depend on the executable name */
+    bool isLaunchApplication(const Application &application) {
+        return !application.isEngine()
+               && application.getSha1().empty()
+               && application.getApplicationNameMatch().empty()
+               && application.getApplicationVersions().empty()
+               && !hasSeparator(application.getExecutable())
+               && !hasSeparator(application.getExecutableRegexp());
+    }
+
+    void appendDevice(std::string &index, const Device_ptr &device, const DriverConfiguration &driverConfiguration) {
+        if (device == nullptr
+            || !EffectiveConfiguration::deviceApplies(device, driverConfiguration.getDriver(),
+                                                      driverConfiguration.getScreen())) {
+            return;
+        }
+
+        const auto &schema = driverConfiguration.getSchema();
+
+        for (const auto &application : device->getApplications()) {
+            if (!isLaunchApplication(*application)) {
+                continue;
+            }
+
+            std::string options;
+            for (const auto &option : application->getOptions()) {
+                if (hasSeparator(option->getName()) || hasSeparator(option->getValue())) {
+                    continue;
+                }
+
+                /* Mesa reads any environment variable named after an option, so only export the real ones */
+                if (schema == nullptr || schema->findOption(option->getName()) == nullptr) {
+                    continue;
+                }
+
+                options.append("O\t").append(option->getName().raw())
+                        .append("\t").append(option->getValue().raw()).append("\n");
+            }
+
+            if (options.empty()) {
+                continue;
+            }
+
+            index.append("A\t").append(application->getExecutable().raw())
+                    .append("\t").append(application->getExecutableRegexp().raw()).append("\n");
+            index.append(options);
+        }
+    }
+}
+
+std::string LaunchIndexBuilder::build(
+        const Device_ptr &systemWideDevice,
+        const DriverConfiguration &driverConfiguration,
+        const std::list<Device_ptr> &userDefinedDevices
+) {
+    std::string index(LAUNCH_INDEX_MAGIC);
+    index.append("\t").append(driverConfiguration.getDriver().raw())
+            .append("\t").append(std::to_string(driverConfiguration.getScreen())).append("\n");
+
+    /* Same precedence as the effective configuration: the user-defined devices come last */
+    appendDevice(index, systemWideDevice, driverConfiguration);
+    for (const auto &device : userDefinedDevices) {
+        appendDevice(index, device, driverConfiguration);
+    }
+
+    return index;
+}
+
+bool LaunchIndexBuilder::write(const std::string &path, const std::string &index) {
+    auto lastSlash = path.find_last_of('/');
+    if (lastSlash != std::string::npos && lastSlash > 0) {
+        g_mkdir_with_parents(path.substr(0, lastSlash).c_str(), 0700);
+    }
+
+    std::string temporaryPath(path + ".tmp");
+    std::ofstream outFile(temporaryPath);
+    outFile << index;
+    outFile.close();
+
+    if (outFile.fail() || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::cerr << Glib::ustring::compose(_("Couldn't write %1: %2"), path, std::strerror(errno)) << std::endl;
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void LaunchIndexBuilder::refresh(
+        const Device_ptr &systemWideDevice,
+        const std::list<DriverConfiguration> &driverConfiguration,
+        const std::list<Device_ptr> &userDefinedDevices
+) {
+    auto path = LaunchIndex::getDefaultPath();
+    std::string driver;
+    int screen = 0;
+
+    if (!LaunchIndex::readTarget(path, driver, screen)) {
+        return;
+    }
+
+    for (const auto &driverConf : driverConfiguration) {
+        if (driverConf.getDriver() == driver && driverConf.getScreen() == screen) {
+            write(path, build(systemWideDevice, driverConf, userDefinedDevices));
+            return;
+        }
+    }
+}
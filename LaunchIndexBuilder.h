@@ -0,0 +1,41 @@
+#ifndef ADRICONF_LAUNCHINDEXBUILDER_H
+#define ADRICONF_LAUNCHINDEXBUILDER_H
+
+#include <list>
+#include <string>
+#include "Device.h"
+#include "DriverConfiguration.h"
+
+/**
+ * Write the launch index of a driver from the system-wide and user-defined configuration
+ * Only the applications that can be decided from the executable name are kept:
+ * engines, sha1 and application name rules need the running process and are skipped.
+ */
+namespace LaunchIndexBuilder {
+    /**
+     * @param systemWideDevice
+     * @param driverConfiguration The driver and screen the index is for
+     * @param userDefinedDevices
+     * @return The index contents, in the format described in LaunchIndex.h
+     */
+    std::string build(
+            const Device_ptr &systemWideDevice,
+            const DriverConfiguration &driverConfiguration,
+            const std::list<Device_ptr> &userDefinedDevices
+    );
+
+    /* Replace the file atomically, as adriconf-run may be reading it */
+    bool write(const std::string &path, const std::string &index);
+
+    /**
+     * Rebuild the default index if it exists, for the driver and screen it was built for
+     * Called after saving so the launcher never uses stale options.
+     */
+    void refresh(
+            const Device_ptr &systemWideDevice,
+            const std::list<DriverConfiguration> &driverConfiguration,
+            const std::list<Device_ptr> &userDefinedDevices
+    );
+};
+
+#endif
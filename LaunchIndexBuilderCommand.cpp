@@ -0,0 +1,55 @@
+#include "CommandLine.h"
+
+#include <iostream>
+#include <string>
+#include <glibmm/i18n.h>
+#include "ConfigurationLoader.h"
+#include "LaunchIndex.h"
+#include "LaunchIndexBuilder.h"
+
+int CommandLine::runIndex(int argc, char *argv[]) {
+    Glib::ustring driver;
+    int screen = -1;
+    std::string outputPath(LaunchIndex::getDefaultPath());
+
+    for (int i = 2; i < argc; i++) {
+        std::string argument(argv[i]);
+        bool hasValue = i + 1 < argc;
+
+        try {
+            if (argument == "--driver" && hasValue) {
+                driver = argv[++i];
+            } else if (argument == "--screen" && hasValue) {
+                screen = std::stoi(argv[++i]);
+            } else if (argument == "--output" && hasValue) {
+                outputPath = argv[++i];
+            } else {
+                printUsage();
+                return 1;
+            }
+        } catch (const std::exception &ex) {
+            std::cerr << Glib::ustring::compose(_("Invalid value for %1"), argument) << std::endl;
+            return 1;
+        }
+    }
+
+    ConfigurationLoader configurationLoader;
+    auto configuration = configurationLoader.loadConcurrently(
+            HEADLESS_LOCALE,
+            ConfigurationLoader::DRIVERS | ConfigurationLoader::SYSTEM_WIDE | ConfigurationLoader::USER_DEFINED
+    );
+    auto &driverConfiguration = configuration.driverConfiguration;
+    auto &systemWideConfiguration = configuration.systemWideConfiguration;
+    auto &userDefinedConfiguration = configuration.userDefinedConfiguration;
+
+    for (const auto &driverConf : driverConfiguration) {
+        if ((driver.empty() || driverConf.getDriver() == driver)
+            && (screen < 0 || driverConf.getScreen() == screen)) {
+            auto index = LaunchIndexBuilder::build(systemWideConfiguration, driverConf, userDefinedConfiguration);
+            return LaunchIndexBuilder::write(outputPath, index) ? 0 : 1;
+        }
+    }
+
+    std::cerr << _("No loaded driver matches the given driver and screen.") << std::endl;
+    return 1;
+}
@@ -0,0 +1,203 @@
+#include "MemoryReport.h"
+
+#include <utility>
+
+namespace {
+    /* Reference counts of a make_shared allocation, next to the object */
+    const std::size_t SHARED_CONTROL_BLOCK_BYTES = 2 * sizeof(void *);
+
+    const char *STRUCTURE_NAMES[] = {
+            "device",
+            "application",
+            "application_option",
+            "driver_configuration",
+            "driver_schema",
+            "section",
+            "driver_option"
+    };
+
+    static_assert(sizeof(STRUCTURE_NAMES) / sizeof(STRUCTURE_NAMES[0])
+                  == static_cast<std::size_t>(MemoryReport::Structure::COUNT),
+                  "Every structure needs a name");
+
+    /* A std::list node holds the value and two pointers */
+    template<typename T>
+    std::size_t listNodeBytes() {
+        return 2 * sizeof(void *) + sizeof(T);
+    }
+
+    /* Short strings are stored inside the object, only longer ones own a heap buffer */
+    std::size_t stringHeapBytes(const std::string &value) {
+        auto data = value.data();
+        auto self = reinterpret_cast<const char *>(&value);
+
+        if (data >= self && data < self + sizeof(value)) {
+            return 0;
+        }
+
+        return value.capacity() + 1;
+    }
+
+    std::size_t stringHeapBytes(const Glib::ustring &value) {
+        return stringHeapBytes(value.raw());
+    }
+}
+
+MemoryReport::MemoryReport() : usages(), visited() {}
+
+MemoryReport::Usage &MemoryReport::getUsage(Structure structure) {
+    return this->usages[static_cast<std::size_t>(structure)];
+}
+
+const MemoryReport::Usage &MemoryReport::getUsage(Structure structure) const {
+    return this->usages[static_cast<std::size_t>(structure)];
+}
+
+bool MemoryReport::visit(const void *object) {
+    return this->visited.insert(object).second;
+}
+
+void MemoryReport::addDevices(const std::list<Device_ptr> &devices) {
+    for (const auto &device : devices) {
+        this->addDevice(device);
+    }
+}
+
+void MemoryReport::addDevice(const Device_ptr &device) {
+    if (device == nullptr || !this->visit(device.get())) {
+        return;
+    }
+
+    auto &usage = this->getUsage(Structure::DEVICE);
+    usage.objects++;
+    usage.bytes += sizeof(Device) + SHARED_CONTROL_BLOCK_BYTES
+                   + device->getApplications().size() * listNodeBytes<Application_ptr>()
+                   + device->getIndexBytes();
+    usage.stringBytes += stringHeapBytes(device->getDriver());
+
+    for (const auto &application : device->getApplications()) {
+        this->addApplication(application);
+    }
+}
+
+void MemoryReport::addApplication(const Application_ptr &application) {
+    if (!this->visit(application.get())) {
+        return;
+    }
+
+    auto &usage = this->getUsage(Structure::APPLICATION);
+    usage.objects++;
+    usage.bytes += sizeof(Application) + SHARED_CONTROL_BLOCK_BYTES
+                   + application->getOptions().size() * listNodeBytes<ApplicationOption_ptr>();
+    usage.stringBytes += stringHeapBytes(application->getName())
+                         + stringHeapBytes(application->getExecutable())
+                         + stringHeapBytes(application->getExecutableRegexp())
+                         + stringHeapBytes(application->getSha1())
+                         + stringHeapBytes(application->getApplicationNameMatch())
+                         + stringHeapBytes(application->getApplicationVersions())
+                         + stringHeapBytes(application->getEngineNameMatch())
+                         + stringHeapBytes(application->getEngineVersions());
+
+    auto &optionUsage = this->getUsage(Structure::APPLICATION_OPTION);
+    for (const auto &option : application->getOptions()) {
+        if (!this->visit(option.get())) {
+            continue;
+        }
+
+        optionUsage.objects++;
+        optionUsage.bytes += sizeof(ApplicationOption) + SHARED_CONTROL_BLOCK_BYTES;
+        optionUsage.stringBytes += stringHeapBytes(option->getName()) + stringHeapBytes(option->getValue());
+    }
+}
+
+void MemoryReport::addDriverConfigurations(const std::list<DriverConfiguration> &driverConfiguration) {
+    auto &usage = this->getUsage(Structure::DRIVER_CONFIGURATION);
+
+    for (const auto &driverConf : driverConfiguration) {
+        usage.objects++;
+        usage.bytes += listNodeBytes<DriverConfiguration>();
+        usage.stringBytes += stringHeapBytes(driverConf.getDriver());
+
+        /* The schema is shared by every screen using the same driver */
+        const auto &schema = driverConf.getSchema();
+        if (schema == nullptr || !this->visit(schema.get())) {
+            continue;
+        }
+
+        auto &schemaUsage = this->getUsage(Structure::DRIVER_SCHEMA);
+        schemaUsage.objects++;
+
+        schemaUsage.bytes += sizeof(DriverSchema) + SHARED_CONTROL_BLOCK_BYTES
+                             + schema->getSections().size() * listNodeBytes<Section>()
+                             + schema->getOptions().capacity() * sizeof(const DriverOption *)
+                             + schema->getIndexBytes();
+
+        for (const auto &section : schema->getSections()) {
+            this->addSection(section);
+        }
+    }
+}
+
+void MemoryReport::addSection(const Section &section) {
+    auto &usage = this->getUsage(Structure::SECTION);
+    usage.objects++;
+    usage.bytes += section.getOptions().size() * listNodeBytes<DriverOption>();
+    usage.stringBytes += stringHeapBytes(section.getDescription());
+
+    auto &optionUsage = this->getUsage(Structure::DRIVER_OPTION);
+    for (const auto &option : section.getOptions()) {
+        const auto &enumValues = option.getEnumValues();
+
+        optionUsage.objects++;
+        optionUsage.bytes += enumValues.size() * listNodeBytes<std::pair<Glib::ustring, Glib::ustring>>();
+        optionUsage.stringBytes += stringHeapBytes(option.getName())
+                                   + stringHeapBytes(option.getDescription())
+                                   + stringHeapBytes(option.getType())
+                                   + stringHeapBytes(option.getDefaultValue())
+                                   + stringHeapBytes(option.getValidValues());
+
+        for (const auto &enumValue : enumValues) {
+            optionUsage.stringBytes += stringHeapBytes(enumValue.first) + stringHeapBytes(enumValue.second);
+        }
+    }
+}
+
+std::size_t MemoryReport::getTotalBytes() const {
+    std::size_t total = 0;
+
+    for (const auto &usage : this->usages) {
+        total += usage.bytes + usage.stringBytes;
+    }
+
+    return total;
+}
+
+const char *MemoryReport::getName(Structure structure) {
+    return STRUCTURE_NAMES[static_cast<std::size_t>(structure)];
+}
+
+std::string MemoryReport::describe() const {
+    std::string output;
+    std::size_t objects = 0, bytes = 0, stringBytes = 0;
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(Structure::COUNT); i++) {
+        const auto &usage = this->usages[i];
+        objects += usage.objects;
+        bytes += usage.bytes;
+        stringBytes += usage.stringBytes;
+
+        output.append(STRUCTURE_NAMES[i]);
+        output.append("\t").append(std::to_string(usage.objects));
+        output.append("\t").append(std::to_string(usage.bytes));
+        output.append("\t").append(std::to_string(usage.stringBytes));
+        output.append("\n");
+    }
+
+    output.append("total");
+    output.append("\t").append(std::to_string(objects));
+    output.append("\t").append(std::to_string(bytes));
+    output.append("\t").append(std::to_string(stringBytes));
+    output.append("\n");
+
+    return output;
+}
@@ -0,0 +1,68 @@
+#ifndef ADRICONF_MEMORYREPORT_H
+#define ADRICONF_MEMORYREPORT_H
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_set>
+#include "Device.h"
+#include "DriverConfiguration.h"
+
+/**
+ * Estimate of the memory used by the configuration model, found by walking it
+ * Each structure is charged for its own size, its shared_ptr control block and the containers it owns,
+ * and separately for the heap buffers of its strings (short strings stored inline cost nothing extra).
+ * Objects shared between devices or history snapshots are counted once. Allocator overhead isn't included.
+ */
+class MemoryReport {
+public:
+    enum class Structure {
+        DEVICE,
+        APPLICATION,
+        APPLICATION_OPTION,
+        DRIVER_CONFIGURATION,
+        DRIVER_SCHEMA,
+        SECTION,
+        DRIVER_OPTION,
+        COUNT
+    };
+
+    struct Usage {
+        std::size_t objects;
+        /* The objects themselves and their containers */
+        std::size_t bytes;
+        std::size_t stringBytes;
+    };
+
+private:
+    Usage usages[static_cast<std::size_t>(Structure::COUNT)];
+    std::unordered_set<const void *> visited;
+
+    Usage &getUsage(Structure structure);
+
+    bool visit(const void *object);
+
+    void addApplication(const Application_ptr &application);
+
+    void addSection(const Section &section);
+
+public:
+    MemoryReport();
+
+    void addDevices(const std::list<Device_ptr> &devices);
+
+    void addDevice(const Device_ptr &device);
+
+    void addDriverConfigurations(const std::list<DriverConfiguration> &driverConfiguration);
+
+    const Usage &getUsage(Structure structure) const;
+
+    std::size_t getTotalBytes() const;
+
+    static const char *getName(Structure structure);
+
+    /* One "<structure><TAB><objects><TAB><bytes><TAB><string bytes>" line per structure, then the total */
+    std::string describe() const;
+};
+
+#endif
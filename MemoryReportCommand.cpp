@@ -0,0 +1,44 @@
+#include "CommandLine.h"
+
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+#include "ConfigurationLoader.h"
+#include "ConfigurationResolver.h"
+#include "MemoryReport.h"
+
+int CommandLine::runMemory(int argc, char *argv[]) {
+    if (argc > 2) {
+        printUsage();
+        return 1;
+    }
+
+    /* Load the model the same way the GUI does */
+    ConfigurationLoader configurationLoader;
+    auto configuration = configurationLoader.loadConcurrently(
+            HEADLESS_LOCALE,
+            ConfigurationLoader::DRIVERS | ConfigurationLoader::SYSTEM_WIDE | ConfigurationLoader::USER_DEFINED
+    );
+    auto &driverConfiguration = configuration.driverConfiguration;
+    auto &systemWideConfiguration = configuration.systemWideConfiguration;
+    auto &userDefinedConfiguration = configuration.userDefinedConfiguration;
+    ConfigurationResolver::filterDriverUnsupportedOptions(driverConfiguration, userDefinedConfiguration);
+    ConfigurationResolver::mergeOptionsForDisplay(systemWideConfiguration, driverConfiguration,
+                                                  userDefinedConfiguration);
+
+    MemoryReport report;
+    report.addDriverConfigurations(driverConfiguration);
+    report.addDevice(systemWideConfiguration);
+    report.addDevices(userDefinedConfiguration);
+
+    std::cout << report.describe();
+
+    /* The second field of statm is the resident size, in pages */
+    std::ifstream statm("/proc/self/statm");
+    std::size_t totalPages = 0, residentPages = 0;
+    if (statm >> totalPages >> residentPages) {
+        std::cout << "process_resident\t\t" << residentPages * sysconf(_SC_PAGESIZE) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include "OptionList.h"
+
+#include <iostream>
+#include <string>
+#include <glibmm/i18n.h>
+
+OptionList::Columns::Columns() {
+    add(name);
+    add(ordinal);
+    add(description);
+    add(valueText);
+    add(kind);
+    add(active);
+    add(showToggle);
+    add(showCombo);
+    add(showSpin);
+    add(showText);
+    add(enumModel);
+    add(adjustment);
+}
+
+OptionList::EnumColumns::EnumColumns() {
+    add(description);
+}
+
+OptionList::OptionList(Gtk::TreeView *treeView) : treeView(treeView) {
+    this->store = Gtk::TreeStore::create(this->columns);
+    this->treeView->set_model(this->store);
+
+    /* Option description */
+    auto descriptionRenderer = Gtk::manage(new Gtk::CellRendererText);
+    descriptionRenderer->property_ellipsize() = Pango::ELLIPSIZE_END;
+
+    auto descriptionColumn = Gtk::manage(new Gtk::TreeViewColumn(_("Option")));
+    descriptionColumn->pack_start(*descriptionRenderer, true);
+    descriptionColumn->add_attribute(descriptionRenderer->property_text(), this->columns.description);
+    descriptionColumn->set_expand(true);
+
+    /* Value, only the renderer matching the option type is visible */
+    auto toggleRenderer = Gtk::manage(new Gtk::CellRendererToggle);
+    toggleRenderer->signal_toggled().connect(sigc::mem_fun(this, &OptionList::onToggled));
+
+    auto comboRenderer = Gtk::manage(new Gtk::CellRendererCombo);
+    comboRenderer->property_text_column() = 0;
+    comboRenderer->property_has_entry() = false;
+    comboRenderer->property_editable() = true;
+    comboRenderer->signal_edited().connect(sigc::mem_fun(this, &OptionList::onEnumEdited));
+
+    auto spinRenderer = Gtk::manage(new Gtk::CellRendererSpin);
+    spinRenderer->property_editable() = true;
+    spinRenderer->signal_edited().connect(sigc::mem_fun(this, &OptionList::onNumberEdited));
+
+    auto textRenderer = Gtk::manage(new Gtk::CellRendererText);
+
+    auto valueColumn = Gtk::manage(new Gtk::TreeViewColumn(_("Value")));
+    valueColumn->pack_start(*toggleRenderer, false);
+    valueColumn->add_attribute(toggleRenderer->property_active(), this->columns.active);
+    valueColumn->add_attribute(toggleRenderer->property_visible(), this->columns.showToggle);
+    valueColumn->pack_start(*comboRenderer, true);
+    valueColumn->add_attribute(comboRenderer->property_text(), this->columns.valueText);
+    valueColumn->add_attribute(comboRenderer->property_model(), this->columns.enumModel);
+    valueColumn->add_attribute(comboRenderer->property_visible(), this->columns.showCombo);
+    valueColumn->pack_start(*spinRenderer, true);
+    valueColumn->add_attribute(spinRenderer->property_text(), this->columns.valueText);
+    valueColumn->add_attribute(spinRenderer->property_adjustment(), this->columns.adjustment);
+    valueColumn->add_attribute(spinRenderer->property_visible(), this->columns.showSpin);
+    valueColumn->pack_start(*textRenderer, true);
+    valueColumn->add_attribute(textRenderer->property_text(), this->columns.valueText);
+    valueColumn->add_attribute(textRenderer->property_visible(), this->columns.showText);
+
+    /* Fixed sizes let the view skip measuring the rows that aren't visible */
+    descriptionColumn->set_sizing(Gtk::TREE_VIEW_COLUMN_FIXED);
+    descriptionColumn->set_fixed_width(500);
+    descriptionColumn->set_resizable(true);
+    valueColumn->set_sizing(Gtk::TREE_VIEW_COLUMN_FIXED);
+    valueColumn->set_fixed_width(200);
+
+    this->treeView->append_column(*descriptionColumn);
+    this->treeView->append_column(*valueColumn);
+    this->treeView->set_fixed_height_mode(true);
+    this->treeView->set_tooltip_column(this->columns.description.index());
+    this->treeView->set_search_column(this->columns.description);
+}
+
+Glib::RefPtr<Gtk::ListStore> OptionList::getEnumModel(std::size_t ordinal) {
+    auto &enumModel = this->enumModels[ordinal];
+
+    if (!enumModel) {
+        enumModel = Gtk::ListStore::create(this->enumColumns);
+        for (const auto &enumValue : this->schema->getOptions()[ordinal]->getEnumValues()) {
+            (*enumModel->append())[this->enumColumns.description] = enumValue.first;
+        }
+    }
+
+    return enumModel;
+}
+
+void OptionList::setOptionRow(Gtk::TreeModel::Row row, std::size_t ordinal, const Glib::ustring &value) {
+    const auto &option = *(this->schema->getOptions()[ordinal]);
+
+    row[this->columns.name] = option.getName();
+    row[this->columns.ordinal] = static_cast<unsigned int>(ordinal);
+    row[this->columns.description] = option.getDescription();
+    row[this->columns.valueText] = value;
+    row[this->columns.active] = false;
+    row[this->columns.showToggle] = false;
+    row[this->columns.showCombo] = false;
+    row[this->columns.showSpin] = false;
+    row[this->columns.showText] = false;
+
+    if (option.getType() == "bool") {
+        row[this->columns.kind] = static_cast<int>(Kind::BOOL);
+        row[this->columns.active] = value == "true";
+        row[this->columns.showToggle] = true;
+    } else if (option.isFakeBool()) {
+        row[this->columns.kind] = static_cast<int>(Kind::FAKE_BOOL);
+        row[this->columns.active] = value == "1";
+        row[this->columns.showToggle] = true;
+    } else if (option.getType() == "enum") {
+        row[this->columns.kind] = static_cast<int>(Kind::ENUM);
+        row[this->columns.enumModel] = this->getEnumModel(ordinal);
+        row[this->columns.showCombo] = true;
+
+        for (const auto &enumValue : option.getEnumValues()) {
+            if (enumValue.second == value) {
+                row[this->columns.valueText] = enumValue.first;
+            }
+        }
+    } else if (option.getType() == "int") {
+        row[this->columns.kind] = static_cast<int>(Kind::INT);
+        row[this->columns.adjustment] = Gtk::Adjustment::create(
+                0, option.getValidValueStart(), option.getValidValueEnd(), 1, 10
+        );
+        row[this->columns.showSpin] = true;
+    } else {
+        row[this->columns.kind] = static_cast<int>(Kind::OTHER);
+        row[this->columns.showText] = true;
+    }
+}
+
+void OptionList::populate(const DriverSchema_ptr &schema, const std::vector<Glib::ustring> &values) {
+    if (schema != this->schema) {
+        this->schema = schema;
+        this->enumModels.assign(schema == nullptr ? 0 : schema->getOptions().size(), Glib::RefPtr<Gtk::ListStore>());
+    }
+
+    /* Detach the model, so the view doesn't follow each row */
+    this->treeView->unset_model();
+    this->store->clear();
+
+    if (this->schema != nullptr) {
+        /* The sections hold the options in the same order as the schema ordinals */
+        std::size_t ordinal = 0;
+
+        for (const auto &section : this->schema->getSections()) {
+            auto sectionRow = *(this->store->append());
+            sectionRow[this->columns.description] = section.getDescription();
+            sectionRow[this->columns.kind] = static_cast<int>(Kind::SECTION);
+            sectionRow[this->columns.showToggle] = false;
+            sectionRow[this->columns.showCombo] = false;
+            sectionRow[this->columns.showSpin] = false;
+            sectionRow[this->columns.showText] = false;
+
+            for (const auto &option : section.getOptions()) {
+                this->setOptionRow(
+                        *(this->store->append(sectionRow.children())),
+                        ordinal,
+                        ordinal < values.size() ? values[ordinal] : option.getDefaultValue()
+                );
+                ordinal++;
+            }
+        }
+    }
+
+    this->treeView->set_model(this->store);
+    this->treeView->expand_all();
+}
+
+void OptionList::emitChanged(Gtk::TreeModel::Row row, const Glib::ustring &value) {
+    Glib::ustring name = row[this->columns.name];
+    this->changedSignal.emit(name, value);
+}
+
+void OptionList::onToggled(const Glib::ustring &path) {
+    auto row = *(this->store->get_iter(path));
+    bool active = row[this->columns.active];
+    int kind = row[this->columns.kind];
+
+    active = !active;
+    row[this->columns.active] = active;
+
+    if (kind == static_cast<int>(Kind::FAKE_BOOL)) {
+        this->emitChanged(row, active ? "1" : "0");
+    } else {
+        this->emitChanged(row, active ? "true" : "false");
+    }
+}
+
+void OptionList::onEnumEdited(const Glib::ustring &path, const Glib::ustring &text) {
+    auto row = *(this->store->get_iter(path));
+    unsigned int ordinal = row[this->columns.ordinal];
+
+    for (const auto &enumValue : this->schema->getOptions()[ordinal]->getEnumValues()) {
+        if (enumValue.first == text) {
+            row[this->columns.valueText] = text;
+            this->emitChanged(row, enumValue.second);
+            return;
+        }
+    }
+}
+
+void OptionList::onNumberEdited(const Glib::ustring &path, const Glib::ustring &text) {
+    auto row = *(this->store->get_iter(path));
+    Glib::RefPtr<Gtk::Adjustment> adjustment = row[this->columns.adjustment];
+
+    int value;
+    try {
+        value = std::stoi(text);
+    } catch (const std::exception &ex) {
+        std::cerr << Glib::ustring::compose(_("Invalid value for %1"), text) << std::endl;
+        return;
+    }
+
+    /* Same limits as the spin buttons */
+    if (value < adjustment->get_lower()) {
+        value = static_cast<int>(adjustment->get_lower());
+    }
+    if (value > adjustment->get_upper()) {
+        value = static_cast<int>(adjustment->get_upper());
+    }
+
+    Glib::ustring valueStr(std::to_string(value));
+    row[this->columns.valueText] = valueStr;
+    this->emitChanged(row, valueStr);
+}
+
+sigc::signal<void, const Glib::ustring &, const Glib::ustring &> &OptionList::signalChanged() {
+    return this->changedSignal;
+}
@@ -0,0 +1,85 @@
+#ifndef ADRICONF_OPTIONLIST_H
+#define ADRICONF_OPTIONLIST_H
+
+#include <vector>
+#include <gtkmm.h>
+#include "DriverSchema.h"
+
+/**
+ * Model-backed view of the options of a driver, an alternative to one widget per option
+ * Each option is a row under its section, edited through cell renderers, so only the visible rows are realized.
+ * Changes are reported through the changed signal, with the value already in the drirc format.
+ */
+class OptionList {
+private:
+    enum class Kind {
+        SECTION,
+        BOOL,
+        FAKE_BOOL,
+        ENUM,
+        INT,
+        OTHER
+    };
+
+    class Columns : public Gtk::TreeModel::ColumnRecord {
+    public:
+        Gtk::TreeModelColumn<Glib::ustring> name;
+        /* Position of the option in the schema */
+        Gtk::TreeModelColumn<unsigned int> ordinal;
+        Gtk::TreeModelColumn<Glib::ustring> description;
+        Gtk::TreeModelColumn<Glib::ustring> valueText;
+        Gtk::TreeModelColumn<int> kind;
+        Gtk::TreeModelColumn<bool> active;
+        Gtk::TreeModelColumn<bool> showToggle;
+        Gtk::TreeModelColumn<bool> showCombo;
+        Gtk::TreeModelColumn<bool> showSpin;
+        Gtk::TreeModelColumn<bool> showText;
+        Gtk::TreeModelColumn<Glib::RefPtr<Gtk::TreeModel>> enumModel;
+        Gtk::TreeModelColumn<Glib::RefPtr<Gtk::Adjustment>> adjustment;
+
+        Columns();
+    };
+
+    class EnumColumns : public Gtk::TreeModel::ColumnRecord {
+    public:
+        Gtk::TreeModelColumn<Glib::ustring> description;
+
+        EnumColumns();
+    };
+
+    Columns columns;
+    EnumColumns enumColumns;
+    Glib::RefPtr<Gtk::TreeStore> store;
+    Gtk::TreeView *treeView;
+    /* Keeps the options alive, the enum models are built once per option of this schema, by ordinal */
+    DriverSchema_ptr schema;
+    std::vector<Glib::RefPtr<Gtk::ListStore>> enumModels;
+    sigc::signal<void, const Glib::ustring &, const Glib::ustring &> changedSignal;
+
+    Glib::RefPtr<Gtk::ListStore> getEnumModel(std::size_t ordinal);
+
+    void setOptionRow(Gtk::TreeModel::Row row, std::size_t ordinal, const Glib::ustring &value);
+
+    void onToggled(const Glib::ustring &path);
+
+    void onEnumEdited(const Glib::ustring &path, const Glib::ustring &text);
+
+    void onNumberEdited(const Glib::ustring &path, const Glib::ustring &text);
+
+    void emitChanged(Gtk::TreeModel::Row row, const Glib::ustring &value);
+
+public:
+    explicit OptionList(Gtk::TreeView *treeView);
+
+    /**
+     * Show the options of a driver
+     * @param schema
+     * @param values The value of every option by ordinal, as resolved for the current application
+     */
+    void populate(const DriverSchema_ptr &schema, const std::vector<Glib::ustring> &values);
+
+    /* Emitted with the option name and its new value */
+    sigc::signal<void, const Glib::ustring &, const Glib::ustring &> &signalChanged();
+};
+
+#endif
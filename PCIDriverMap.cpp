@@ -0,0 +1,115 @@
+#include "PCIDriverMap.h"
+
+#include <algorithm>
+#include <iterator>
+
+#define PCI_VENDOR_INTEL 0x8086
+#define PCI_VENDOR_AMD 0x1002
+
+namespace {
+    struct ChipRange {
+        uint16_t first;
+        uint16_t last;
+        const char *driver;
+    };
+
+    /* i915_pci_ids.h: gen3, the older chips have no driver anymore */
+    const uint16_t I915_CHIP_IDS[] = {
+            0x2582, 0x258a, 0x2592, 0x2772, 0x27a2, 0x27ae, 0x29b2, 0x29c2, 0x29d2, 0xa001, 0xa011
+    };
+
+    /* crocus_pci_ids.h: gen4 to gen7.5 (Broadwater to Haswell), the later chips use iris */
+    const uint16_t CROCUS_CHIP_IDS[] = {
+            /* Gen4, G4x */
+            0x2972, 0x2982, 0x2992, 0x29a2, 0x2a02, 0x2a12, 0x2a42,
+            0x2e02, 0x2e12, 0x2e22, 0x2e32, 0x2e42, 0x2e92,
+            /* Ironlake */
+            0x0042, 0x0046,
+            /* Sandy Bridge */
+            0x0102, 0x0106, 0x010a, 0x0112, 0x0116, 0x0122, 0x0126,
+            /* Ivy Bridge, Bay Trail */
+            0x0152, 0x0155, 0x0156, 0x0157, 0x015a, 0x0162, 0x0166, 0x016a, 0x0f31, 0x0f32, 0x0f33,
+            /* Haswell */
+            0x0402, 0x0406, 0x040a, 0x040b, 0x040e, 0x0412, 0x0416, 0x041a, 0x041b, 0x041e,
+            0x0422, 0x0426, 0x042a, 0x042b, 0x042e,
+            0x0a02, 0x0a06, 0x0a0a, 0x0a0b, 0x0a0e, 0x0a12, 0x0a16, 0x0a1a, 0x0a1b, 0x0a1e,
+            0x0a22, 0x0a26, 0x0a2a, 0x0a2b, 0x0a2e,
+            0x0c02, 0x0c06, 0x0c0a, 0x0c0b, 0x0c0e, 0x0c12, 0x0c16, 0x0c1a, 0x0c1b, 0x0c1e,
+            0x0c22, 0x0c26, 0x0c2a, 0x0c2b, 0x0c2e,
+            0x0d02, 0x0d06, 0x0d0a, 0x0d0b, 0x0d0e, 0x0d12, 0x0d16, 0x0d1a, 0x0d1b, 0x0d1e,
+            0x0d22, 0x0d26, 0x0d2a, 0x0d2b, 0x0d2e
+    };
+
+    /* Chips the radeon kernel driver supports, by family (r300_pci_ids.h, r600_pci_ids.h, radeonsi_pci_ids.h) */
+    const ChipRange RADEON_CHIP_RANGES[] = {
+            /* R300 to R500 */
+            {0x3150, 0x3155, "r300"},
+            {0x3e50, 0x3e54, "r300"},
+            {0x4144, 0x4157, "r300"},
+            {0x4a48, 0x4a54, "r300"},
+            {0x4b48, 0x4b4c, "r300"},
+            {0x4e44, 0x4e56, "r300"},
+            {0x5460, 0x5465, "r300"},
+            {0x5548, 0x5557, "r300"},
+            {0x564a, 0x5657, "r300"},
+            {0x5954, 0x5955, "r300"},
+            {0x5974, 0x5975, "r300"},
+            {0x5a41, 0x5a42, "r300"},
+            {0x5a61, 0x5a62, "r300"},
+            {0x5b60, 0x5b65, "r300"},
+            {0x5d48, 0x5d57, "r300"},
+            {0x7100, 0x7297, "r300"},
+            {0x791e, 0x791f, "r300"},
+            {0x793f, 0x7942, "r300"},
+            {0x796c, 0x796f, "r300"},
+            /* Southern Islands and Sea Islands, before amdgpu took them over */
+            {0x1304, 0x131d, "radeonsi"},
+            {0x6600, 0x666f, "radeonsi"},
+            {0x6780, 0x67bf, "radeonsi"},
+            {0x6800, 0x683f, "radeonsi"},
+            {0x9830, 0x983f, "radeonsi"},
+            {0x9850, 0x985f, "radeonsi"},
+            /* R600 to Northern Islands */
+            {0x6700, 0x677f, "r600"},
+            {0x6880, 0x68ff, "r600"},
+            {0x9400, 0x95ff, "r600"},
+            {0x9610, 0x961f, "r600"},
+            {0x9640, 0x964f, "r600"},
+            {0x9710, 0x971f, "r600"},
+            {0x9802, 0x980a, "r600"},
+            {0x9900, 0x99ff, "r600"}
+    };
+
+    bool contains(const uint16_t *first, const uint16_t *last, uint16_t deviceId) {
+        return std::find(first, last, deviceId) != last;
+    }
+}
+
+const char *PCIDriverMap::findDriver(const std::string &kernelDriver, uint16_t vendorId, uint16_t deviceId) {
+    if (vendorId == PCI_VENDOR_INTEL && (kernelDriver == "i915" || kernelDriver == "xe")) {
+        if (contains(std::begin(I915_CHIP_IDS), std::end(I915_CHIP_IDS), deviceId)) {
+            return "i915";
+        }
+
+        if (contains(std::begin(CROCUS_CHIP_IDS), std::end(CROCUS_CHIP_IDS), deviceId)) {
+            return "crocus";
+        }
+
+        /* Every generation before Broadwell is listed above */
+        return "iris";
+    }
+
+    if (vendorId == PCI_VENDOR_AMD && kernelDriver == "amdgpu") {
+        return "radeonsi";
+    }
+
+    if (vendorId == PCI_VENDOR_AMD && kernelDriver == "radeon") {
+        for (const auto &range : RADEON_CHIP_RANGES) {
+            if (deviceId >= range.first && deviceId <= range.last) {
+                return range.driver;
+            }
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,23 @@
+#ifndef ADRICONF_PCIDRIVERMAP_H
+#define ADRICONF_PCIDRIVERMAP_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * The DRI driver Mesa's loader picks for a PCI device, from its ids
+ * Same tables as Mesa's loader (pci_id_driver_map.h and include/pci_ids), reduced to the kernel drivers
+ * where several DRI drivers share a vendor: i915/xe (iris, crocus, i915) and radeon (radeonsi, r600, r300).
+ * amdgpu always uses radeonsi. Every other kernel driver has a single DRI driver, found by name.
+ */
+namespace PCIDriverMap {
+    /**
+     * @param kernelDriver Name of the DRM driver, as in the sysfs module
+     * @param vendorId
+     * @param deviceId
+     * @return The DRI driver name, or nullptr when the device isn't in the tables
+     */
+    const char *findDriver(const std::string &kernelDriver, uint16_t vendorId, uint16_t deviceId);
+};
+
+#endif
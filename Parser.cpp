@@ -1,4 +1,11 @@
 #include "Parser.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <libxml/parser.h>
+#include "Counters.h"
+#include "DocumentSplitter.h"
 
 std::list<Section>
 Parser::parseAvailableConfiguration(const Glib::ustring &xml, const Glib::ustring &currentLocale) {
@@ -14,11 +21,14 @@ Parser::parseAvailableConfiguration(const Glib::ustring &xml, const Glib::ustrin
             auto rootNode = parser.get_document()->get_root_node();
 
             auto sections = rootNode->get_children("section");
+            std::size_t visitedNodes = 1 + sections.size();
+
             for (auto section : sections) {
                 Section confSection;
 
 
                 auto descriptions = section->get_children("description");
+                visitedNodes += descriptions.size();
                 Glib::ustring englishName;
                 Glib::ustring localizedName;
 
@@ -48,6 +58,9 @@ Parser::parseAvailableConfiguration(const Glib::ustring &xml, const Glib::ustrin
 
                 availableSections.push_back(confSection);
             }
+
+            /* The options count their own nodes */
+            Counters::add(Counters::Counter::XML_NODES_VISITED, visitedNodes);
         }
 
     } catch (const std::exception &ex) {
@@ -76,6 +89,7 @@ DriverOption Parser::parseSectionOptions(xmlpp::Node *option, const Glib::ustrin
     }
 
     auto descriptions = option->get_children("description");
+    std::size_t visitedNodes = 1 + descriptions.size();
 
     xmlpp::Node *descriptionHolder = nullptr;
     Glib::ustring correctDescription;
@@ -103,6 +117,8 @@ DriverOption Parser::parseSectionOptions(xmlpp::Node *option, const Glib::ustrin
     if (parsedOption.getType() == "enum") {
         if (descriptionHolder != nullptr) {
             auto enumOptions = descriptionHolder->get_children("enum");
+            visitedNodes += enumOptions.size();
+
             for (auto enumOption : enumOptions) {
                 auto enumElement = dynamic_cast<xmlpp::Element *>(enumOption);
                 Glib::ustring value(enumElement->get_attribute("value")->get_value());
@@ -113,23 +129,26 @@ DriverOption Parser::parseSectionOptions(xmlpp::Node *option, const Glib::ustrin
         }
     }
 
+    Counters::add(Counters::Counter::XML_NODES_VISITED, visitedNodes);
+
     return parsedOption;
 }
 
-std::list<Device_ptr> Parser::parseDevices(Glib::ustring &xml) {
-    std::list<Device_ptr> deviceList;
-
-    try {
+namespace {
+    /* Throws on invalid documents, leaving the devices read so far in the list */
+    void readDevices(const std::string &xml, std::list<Device_ptr> &deviceList) {
         xmlpp::DomParser parser;
         parser.set_throw_messages(true);
         parser.set_substitute_entities(true);
         parser.set_include_default_attributes(true);
-        parser.parse_memory(xml);
+        parser.parse_memory_raw(reinterpret_cast<const unsigned char *>(xml.data()), xml.size());
 
         if (parser) {
             auto rootNode = parser.get_document()->get_root_node();
 
             auto devices = rootNode->get_children("device");
+            std::size_t visitedNodes = 1 + devices.size();
+
             for (auto device : devices) {
                 auto deviceConf = std::make_shared<Device>();
 
@@ -144,18 +163,115 @@ std::list<Device_ptr> Parser::parseDevices(Glib::ustring &xml) {
                     deviceConf->setDriver(deviceDriver->get_value());
                 }
 
-                auto applications = device->get_children("application");
+                /* Applications and engines must keep the document order, as later ones take precedence */
+                auto applications = device->get_children();
+                visitedNodes += applications.size();
 
                 for (auto application : applications) {
-                    auto parsedApp = parseApplication(application);
+                    if (application->get_name() != "application" && application->get_name() != "engine") {
+                        continue;
+                    }
+
+                    auto parsedApp = Parser::parseApplication(application);
                     deviceConf->addApplication(parsedApp);
                 }
 
                 deviceList.emplace_back(deviceConf);
             }
+
+            /* The applications count their own options */
+            Counters::add(Counters::Counter::XML_NODES_VISITED, visitedNodes);
         }
+    }
+}
+
+std::list<Device_ptr> Parser::parseDevices(Glib::ustring &xml, Glib::ustring *error) {
+    return parseDevicesRaw(xml.raw(), error);
+}
+
+std::list<Device_ptr> Parser::parseDevicesRaw(const std::string &xml, Glib::ustring *error) {
+    std::list<Device_ptr> deviceList;
+
+    try {
+        readDevices(xml, deviceList);
     } catch (const std::exception &ex) {
-        std::cerr << "Exception caught: " << ex.what() << std::endl;
+        if (error != nullptr) {
+            *error = ex.what();
+            deviceList.clear();
+        } else {
+            std::cerr << "Exception caught: " << ex.what() << std::endl;
+        }
+    }
+
+    return deviceList;
+}
+
+std::list<Device_ptr> Parser::parseDevicesParallel(Glib::ustring &xml, unsigned int threadCount, Glib::ustring *error) {
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    /* With a single worker the scan and the copies would only add to the serial time */
+    std::vector<DocumentSplitter::Chunk> chunks;
+    if (threadCount < 2 || xml.bytes() < PARALLEL_PARSE_MIN_BYTES
+        || !DocumentSplitter::split(xml.raw(), PARALLEL_PARSE_CHUNK_BYTES, chunks)
+        || chunks.size() < 2) {
+        return parseDevices(xml, error);
+    }
+
+    if (threadCount > chunks.size()) {
+        threadCount = static_cast<unsigned int>(chunks.size());
+    }
+
+    /* libxml2 must be initialized once before being used from several threads */
+    xmlInitParser();
+
+    std::vector<std::list<Device_ptr>> results(chunks.size());
+    std::atomic<std::size_t> nextChunk(0);
+    std::atomic<bool> failed(false);
+
+    auto worker = [&]() {
+        std::size_t chunkIndex;
+
+        while (!failed.load(std::memory_order_relaxed)
+               && (chunkIndex = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunks.size()) {
+            try {
+                readDevices(chunks[chunkIndex].xml, results[chunkIndex]);
+            } catch (const std::exception &ex) {
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threadCount; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+
+    for (auto &thread : workers) {
+        thread.join();
+    }
+
+    /* Every chunk holds exactly one device, anything else is an error the serial parser must report */
+    std::list<Device_ptr> deviceList;
+    for (std::size_t i = 0; i < chunks.size() && !failed; i++) {
+        if (results[i].size() != 1) {
+            failed = true;
+            break;
+        }
+
+        if (chunks[i].continuation && !deviceList.empty()) {
+            for (const auto &application : results[i].front()->getApplications()) {
+                deviceList.back()->addApplication(application);
+            }
+        } else {
+            deviceList.emplace_back(results[i].front());
+        }
+    }
+
+    if (failed) {
+        return parseDevices(xml, error);
     }
 
     return deviceList;
@@ -176,7 +292,43 @@ Application_ptr Parser::parseApplication(xmlpp::Node *application) {
         app->setExecutable(applicationExecutable->get_value());
     }
 
+    auto executableRegexp = applicationElement->get_attribute("executable_regexp");
+    if (executableRegexp != nullptr) {
+        app->setExecutableRegexp(executableRegexp->get_value());
+    }
+
+    auto sha1 = applicationElement->get_attribute("sha1");
+    if (sha1 != nullptr) {
+        app->setSha1(sha1->get_value());
+    }
+
+    auto applicationNameMatch = applicationElement->get_attribute("application_name_match");
+    if (applicationNameMatch != nullptr) {
+        app->setApplicationNameMatch(applicationNameMatch->get_value());
+    }
+
+    auto applicationVersions = applicationElement->get_attribute("application_versions");
+    if (applicationVersions != nullptr) {
+        app->setApplicationVersions(applicationVersions->get_value());
+    }
+
+    if (application->get_name() == "engine") {
+        app->setEngine(true);
+
+        auto engineNameMatch = applicationElement->get_attribute("engine_name_match");
+        if (engineNameMatch != nullptr) {
+            app->setEngineNameMatch(engineNameMatch->get_value());
+        }
+
+        auto engineVersions = applicationElement->get_attribute("engine_versions");
+        if (engineVersions != nullptr) {
+            app->setEngineVersions(engineVersions->get_value());
+        }
+    }
+
     auto options = application->get_children("option");
+    Counters::add(Counters::Counter::XML_NODES_VISITED, options.size());
+    uint64_t allocatedOptions = 0;
 
     for (auto option : options) {
         auto optionElement = dynamic_cast<xmlpp::Element *>(option);
@@ -186,34 +338,13 @@ Application_ptr Parser::parseApplication(xmlpp::Node *application) {
             auto newOption = std::make_shared<ApplicationOption>();
             newOption->setName(optionName->get_value());
             newOption->setValue(optionValue->get_value());
+            allocatedOptions++;
 
             app->addOption(newOption);
         }
     }
 
-    return app;
-}
+    Counters::add(Counters::Counter::OPTIONS_ALLOCATED, allocatedOptions);
 
-std::list<Glib::ustring> Parser::convertSectionsToOptions(const std::list<Section> &sections) {
-    std::list<Glib::ustring> options;
-
-    for (auto &section : sections) {
-        for (const auto &option : section.getOptions()) {
-            options.emplace_back(option.getName());
-        }
-    }
-
-    return options;
-}
-
-std::list<DriverOption> Parser::convertSectionsToOptionsObject(const std::list<Section> &sections) {
-    std::list<DriverOption> options;
-
-    for (const auto &section : sections) {
-        for (const auto &option : section.getOptions()) {
-            options.emplace_back(option);
-        }
-    }
-
-    return options;
+    return app;
 }
\ No newline at end of file
@@ -7,18 +7,37 @@
 #include <libxml++/libxml++.h>
 #include <list>
 
+/* Smaller documents are parsed on the calling thread, as starting the workers would cost more */
+#define PARALLEL_PARSE_MIN_BYTES (1024 * 1024)
+/* Devices bigger than this are parsed in pieces, cut between applications */
+#define PARALLEL_PARSE_CHUNK_BYTES (256 * 1024)
+
 namespace Parser {
     std::list<Section> parseAvailableConfiguration(const Glib::ustring &xml, const Glib::ustring &currentLocale);
 
     DriverOption parseSectionOptions(xmlpp::Node *option, const Glib::ustring &currentLocale);
 
-    std::list<Device_ptr> parseDevices(Glib::ustring &xml);
+    /**
+     * @param xml
+     * @param error When given, receives the parse error and the list is left empty. Otherwise the error is
+     * logged and the devices read before it are returned
+     */
+    std::list<Device_ptr> parseDevices(Glib::ustring &xml, Glib::ustring *error = nullptr);
+
+    /* Same as parseDevices, for a document already held in a std::string so it isn't copied */
+    std::list<Device_ptr> parseDevicesRaw(const std::string &xml, Glib::ustring *error = nullptr);
+
+    /**
+     * Same result as parseDevices, parsing the devices (and pieces of big devices) on several threads
+     * Documents that can't be split safely (see DocumentSplitter) or that fail to parse are handed to parseDevices.
+     * @param xml
+     * @param threadCount Number of workers, 0 to use one per CPU
+     * @param error Same as for parseDevices
+     */
+    std::list<Device_ptr> parseDevicesParallel(Glib::ustring &xml, unsigned int threadCount = 0,
+                                               Glib::ustring *error = nullptr);
 
     Application_ptr parseApplication(xmlpp::Node *application);
-
-    std::list<DriverOption> convertSectionsToOptionsObject(const std::list<Section> &sections);
-
-    std::list<Glib::ustring> convertSectionsToOptions(const std::list<Section> &sections);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "SysfsEnumerator.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+
+namespace {
+    bool isCardName(const char *name) {
+        /* Skip the connectors, like card0-HDMI-A-1 */
+        if (std::strncmp(name, "card", 4) != 0 || name[4] == '\0') {
+            return false;
+        }
+
+        for (auto character = name + 4; *character != '\0'; character++) {
+            if (*character < '0' || *character > '9') {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<std::string> listDirectory(const std::string &path) {
+        std::vector<std::string> entries;
+
+        DIR *directory = opendir(path.c_str());
+        if (directory == nullptr) {
+            return entries;
+        }
+
+        while (auto entry = readdir(directory)) {
+            if (entry->d_name[0] != '.') {
+                entries.emplace_back(entry->d_name);
+            }
+        }
+
+        closedir(directory);
+
+        return entries;
+    }
+
+    /* Name of the directory a path resolves to, following every link */
+    std::string resolveName(const std::string &path) {
+        char resolved[PATH_MAX];
+        if (realpath(path.c_str(), resolved) == nullptr) {
+            return std::string();
+        }
+
+        auto name = std::strrchr(resolved, '/');
+        return name == nullptr ? std::string(resolved) : std::string(name + 1);
+    }
+
+    uint16_t readHexAttribute(const std::string &path) {
+        std::ifstream attribute(path);
+        std::string value;
+
+        if (!(attribute >> value)) {
+            return 0;
+        }
+
+        return static_cast<uint16_t>(std::strtoul(value.c_str(), nullptr, 16));
+    }
+
+    std::string toBusId(const std::string &bus, const std::string &deviceName) {
+        /* 0000:01:00.0 becomes pci-0000_01_00_0 */
+        std::string busId(bus + "-" + deviceName);
+        std::replace(busId.begin() + bus.length(), busId.end(), ':', '_');
+        std::replace(busId.begin() + bus.length(), busId.end(), '.', '_');
+
+        return busId;
+    }
+
+    unsigned long cardNumber(const std::string &name) {
+        return std::strtoul(name.c_str() + 4, nullptr, 10);
+    }
+}
+
+std::string SysfsEnumerator::getDefaultRoot() {
+    const char *root = std::getenv("ADRICONF_SYSFS_ROOT");
+    if (root != nullptr && root[0] != '\0') {
+        return root;
+    }
+
+    return SYSFS_DEFAULT_ROOT;
+}
+
+std::vector<SysfsEnumerator::Card> SysfsEnumerator::enumerate(const std::string &root) {
+    std::vector<Card> cards;
+    std::string classPath(root + "/class/drm/");
+
+    for (const auto &entry : listDirectory(classPath)) {
+        if (!isCardName(entry.c_str())) {
+            continue;
+        }
+
+        /* Virtual cards (vgem, vkms) may have no parent device */
+        std::string devicePath(classPath + entry + "/device");
+        auto deviceName = resolveName(devicePath);
+        if (deviceName.empty()) {
+            continue;
+        }
+
+        Card card;
+        card.name = entry;
+        /*
+         * The module is named after the DRM driver (vc4, msm), while the bound driver may be a platform
+         * driver of the module (vc4_drm, msm_dpu). Drivers built into the kernel have no module link
+         */
+        card.driverName = resolveName(devicePath + "/driver/module");
+        if (card.driverName.empty()) {
+            card.driverName = resolveName(devicePath + "/driver");
+        }
+        card.bus = resolveName(devicePath + "/subsystem");
+        card.vendorId = 0;
+        card.deviceId = 0;
+
+        for (const auto &node : listDirectory(devicePath + "/drm")) {
+            if (node.compare(0, 7, "renderD") == 0) {
+                card.renderNode = node;
+            }
+        }
+
+        /* A virtio GPU sits on a virtio bus, itself a PCI device. libdrm reports it as that PCI device too */
+        std::string busPath(devicePath);
+        if (card.bus == "virtio" && resolveName(devicePath + "/../subsystem") == "pci") {
+            busPath = devicePath + "/..";
+            deviceName = resolveName(busPath);
+            card.bus = "pci";
+        }
+
+        card.busId = toBusId(card.bus, deviceName);
+
+        if (card.bus == "pci") {
+            card.vendorId = readHexAttribute(busPath + "/vendor");
+            card.deviceId = readHexAttribute(busPath + "/device");
+        }
+
+        cards.emplace_back(card);
+    }
+
+    std::sort(cards.begin(), cards.end(), [](const Card &a, const Card &b) {
+        return cardNumber(a.name) < cardNumber(b.name);
+    });
+
+    return cards;
+}
@@ -0,0 +1,50 @@
+#ifndef ADRICONF_SYSFSENUMERATOR_H
+#define ADRICONF_SYSFSENUMERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define SYSFS_DEFAULT_ROOT "/sys"
+
+/**
+ * List the DRM devices from sysfs, without opening their device nodes
+ * Opening a node wakes a GPU in runtime suspend, reading the attributes of its sysfs directory doesn't.
+ * The root is a parameter, so the same code runs against a copy of a sysfs tree.
+ *
+ * Layout read, relative to the root:
+ *   class/drm/card<N>/device               Link to the device, its name is the bus address
+ *   class/drm/card<N>/device/driver        Link to the bound kernel driver
+ *   class/drm/card<N>/device/driver/module Link to the module of that driver, named after the DRM driver
+ *   class/drm/card<N>/device/subsystem     Link to the bus (pci, platform, virtio...)
+ *   class/drm/card<N>/device/vendor        PCI vendor id, "0x1002"
+ *   class/drm/card<N>/device/device        PCI device id
+ *   class/drm/card<N>/device/drm/renderD<M> Render node of the device, if it has one
+ */
+namespace SysfsEnumerator {
+    struct Card {
+        /* card0 */
+        std::string name;
+        /* renderD128, empty for display-only devices */
+        std::string renderNode;
+        std::string driverName;
+        /* pci, platform, usb... */
+        std::string bus;
+        /* Same form as the udev ID_PATH: pci-0000_01_00_0 or platform-<device> */
+        std::string busId;
+        /* Only known for PCI devices, 0 otherwise */
+        uint16_t vendorId;
+        uint16_t deviceId;
+    };
+
+    /* $ADRICONF_SYSFS_ROOT, or /sys */
+    std::string getDefaultRoot();
+
+    /**
+     * @param root The directory sysfs is mounted on
+     * @return The cards, ordered by their number. Empty if the root has no DRM class
+     */
+    std::vector<Card> enumerate(const std::string &root);
+};
+
+#endif
@@ -1,49 +1,77 @@
 #include "Writer.h"
-#include <libxml++/libxml++.h>
+#include "XMLEscape.h"
+#include "Counters.h"
+#include <iostream>
+#include <glibmm/i18n.h>
+
+namespace {
+    std::size_t appendAttribute(std::string &output, const char *name, const Glib::ustring &value) {
+        if (value.empty()) {
+            return 0;
+        }
+
+        output.append(" ");
+        output.append(name);
+        output.append("=\"");
+        auto replaced = XMLEscape::appendEscaped(output, value.raw());
+        output.append("\"");
+
+        return replaced;
+    }
+}
 
 Glib::ustring Writer::generateRawXml(const std::list<Device_ptr> &devices) {
-    Glib::ustring output("<driconf>\n");
+    /* Built as raw bytes, the escaping stage already guarantees valid UTF-8 */
+    std::string output("<driconf>\n");
+    std::size_t replaced = 0;
 
     for (const auto &device : devices) {
         output.append("  <device screen=\"");
         output.append(std::to_string(device->getScreen()));
         output.append("\" driver=\"");
-        output.append(device->getDriver());
+        replaced += XMLEscape::appendEscaped(output, device->getDriver().raw());
         output.append("\">\n");
 
         for (const auto &app : device->getApplications()) {
-            output.append("    <application");
-            if (!app->getName().empty()) {
-                output.append(" name=\"");
-                /* TODO: Check if we need to make a special escaping here */
-                output.append(app->getName());
-                output.append("\"");
-            }
-
-            if (!app->getExecutable().empty()) {
-                /* TODO: Check if we need to scape this too. */
-                output.append(" executable=\"");
-                output.append(app->getExecutable());
-                output.append("\"");
-            }
+            const char *tagName = app->isEngine() ? "engine" : "application";
 
+            output.append("    <");
+            output.append(tagName);
+            replaced += appendAttribute(output, "name", app->getName());
+            replaced += appendAttribute(output, "executable", app->getExecutable());
+            replaced += appendAttribute(output, "executable_regexp", app->getExecutableRegexp());
+            replaced += appendAttribute(output, "sha1", app->getSha1());
+            replaced += appendAttribute(output, "application_name_match", app->getApplicationNameMatch());
+            replaced += appendAttribute(output, "application_versions", app->getApplicationVersions());
+            replaced += appendAttribute(output, "engine_name_match", app->getEngineNameMatch());
+            replaced += appendAttribute(output, "engine_versions", app->getEngineVersions());
             output.append(">\n");
 
             for (const auto &option : app->getOptions()) {
                 output.append("      <option name=\"");
-                output.append(option->getName());
+                replaced += XMLEscape::appendEscaped(output, option->getName().raw());
                 output.append("\" value=\"");
-                output.append(option->getValue());
+                replaced += XMLEscape::appendEscaped(output, option->getValue().raw());
                 output.append("\" />\n");
             }
 
-            output.append("    </application>\n");
+            output.append("    </");
+            output.append(tagName);
+            output.append(">\n");
         }
 
         output.append("  </device>\n");
     }
 
     output.append("</driconf>");
+    Counters::add(Counters::Counter::BYTES_WRITTEN, output.size());
+
+    if (replaced > 0) {
+        std::cerr << Glib::ustring::compose(
+                _("%1 invalid characters were replaced or removed while generating the XML."),
+                replaced
+        ) << std::endl;
+    }
 
-    return output;
-}
\ No newline at end of file
+    return Glib::ustring(std::move(output));
+}
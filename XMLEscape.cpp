@@ -0,0 +1,223 @@
+#include "XMLEscape.h"
+
+#include <cstdint>
+
+/* SSE2 is part of x86-64, but only available on i386 when the build targets it (-msse2) */
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define XMLESCAPE_X86 1
+#endif
+
+namespace {
+    /*
+     * Every byte that can't be copied directly: the XML special characters, control characters
+     * and anything outside ASCII, which must have its UTF-8 sequence validated.
+     */
+    inline bool needsAttention(unsigned char c) {
+        return c < 0x20 || c >= 0x80 || c == '&' || c == '<' || c == '>' || c == '"';
+    }
+
+    std::size_t findScalar(const unsigned char *data, std::size_t position, std::size_t length) {
+        while (position < length && !needsAttention(data[position])) {
+            position++;
+        }
+
+        return position;
+    }
+
+#ifdef XMLESCAPE_X86
+
+    /* As signed bytes, both the control characters and the non-ASCII bytes are lower than 0x20 */
+    std::size_t findSSE2(const unsigned char *data, std::size_t position, std::size_t length) {
+        const __m128i controlLimit = _mm_set1_epi8(0x20);
+        const __m128i ampersand = _mm_set1_epi8('&');
+        const __m128i lessThan = _mm_set1_epi8('<');
+        const __m128i greaterThan = _mm_set1_epi8('>');
+        const __m128i quote = _mm_set1_epi8('"');
+
+        while (position + 16 <= length) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + position));
+
+            __m128i special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmplt_epi8(chunk, controlLimit), _mm_cmpeq_epi8(chunk, ampersand)),
+                    _mm_or_si128(
+                            _mm_or_si128(_mm_cmpeq_epi8(chunk, lessThan), _mm_cmpeq_epi8(chunk, greaterThan)),
+                            _mm_cmpeq_epi8(chunk, quote)
+                    )
+            );
+
+            auto mask = static_cast<unsigned int>(_mm_movemask_epi8(special));
+            if (mask != 0) {
+                return position + __builtin_ctz(mask);
+            }
+
+            position += 16;
+        }
+
+        return findScalar(data, position, length);
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t findAVX2(const unsigned char *data, std::size_t position, std::size_t length) {
+        const __m256i controlLimit = _mm256_set1_epi8(0x20);
+        const __m256i ampersand = _mm256_set1_epi8('&');
+        const __m256i lessThan = _mm256_set1_epi8('<');
+        const __m256i greaterThan = _mm256_set1_epi8('>');
+        const __m256i quote = _mm256_set1_epi8('"');
+
+        while (position + 32 <= length) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + position));
+
+            __m256i special = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpgt_epi8(controlLimit, chunk), _mm256_cmpeq_epi8(chunk, ampersand)),
+                    _mm256_or_si256(
+                            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lessThan), _mm256_cmpeq_epi8(chunk, greaterThan)),
+                            _mm256_cmpeq_epi8(chunk, quote)
+                    )
+            );
+
+            auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(special));
+            if (mask != 0) {
+                return position + __builtin_ctz(mask);
+            }
+
+            position += 32;
+        }
+
+        return findSSE2(data, position, length);
+    }
+
+    typedef std::size_t (*FindFunction)(const unsigned char *, std::size_t, std::size_t);
+
+    FindFunction selectFind() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return findAVX2;
+        }
+
+        return findSSE2;
+    }
+
+    /* The best implementation for this CPU, checked only once */
+    const FindFunction findSpecial = selectFind();
+
+#else
+
+    const auto findSpecial = findScalar;
+
+#endif
+
+    /**
+     * Check the UTF-8 sequence starting at the given position
+     * @return The sequence length, or 0 if it is invalid (overlong, surrogate, truncated or out of range)
+     */
+    std::size_t validSequenceLength(const unsigned char *data, std::size_t position, std::size_t length) {
+        unsigned char first = data[position];
+        std::size_t sequenceLength;
+        uint32_t codePoint;
+
+        if (first >= 0xC2 && first <= 0xDF) {
+            sequenceLength = 2;
+            codePoint = first & 0x1Fu;
+        } else if (first >= 0xE0 && first <= 0xEF) {
+            sequenceLength = 3;
+            codePoint = first & 0x0Fu;
+        } else if (first >= 0xF0 && first <= 0xF4) {
+            sequenceLength = 4;
+            codePoint = first & 0x07u;
+        } else {
+            return 0;
+        }
+
+        if (position + sequenceLength > length) {
+            return 0;
+        }
+
+        for (std::size_t i = 1; i < sequenceLength; i++) {
+            unsigned char next = data[position + i];
+            if ((next & 0xC0) != 0x80) {
+                return 0;
+            }
+
+            codePoint = (codePoint << 6) | (next & 0x3Fu);
+        }
+
+        if ((sequenceLength == 3 && codePoint < 0x800)
+            || (sequenceLength == 4 && (codePoint < 0x10000 || codePoint > 0x10FFFF))
+            || (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+            || codePoint == 0xFFFE || codePoint == 0xFFFF) {
+            return 0;
+        }
+
+        return sequenceLength;
+    }
+}
+
+std::size_t XMLEscape::appendEscaped(std::string &output, const char *data, std::size_t length) {
+    auto bytes = reinterpret_cast<const unsigned char *>(data);
+    std::size_t replaced = 0;
+    std::size_t position = 0;
+
+    while (position < length) {
+        std::size_t special = findSpecial(bytes, position, length);
+
+        /* Copy the clean run at once */
+        if (special > position) {
+            output.append(data + position, special - position);
+        }
+
+        if (special >= length) {
+            break;
+        }
+
+        unsigned char c = bytes[special];
+        position = special + 1;
+
+        switch (c) {
+            case '&':
+                output.append("&amp;");
+                break;
+            case '<':
+                output.append("&lt;");
+                break;
+            case '>':
+                output.append("&gt;");
+                break;
+            case '"':
+                output.append("&quot;");
+                break;
+            /* Attribute values have their white-space normalized, so we keep them as references */
+            case '\t':
+                output.append("&#9;");
+                break;
+            case '\n':
+                output.append("&#10;");
+                break;
+            case '\r':
+                output.append("&#13;");
+                break;
+            default:
+                if (c < 0x20) {
+                    /* Not allowed in XML 1.0, not even as a reference */
+                    replaced++;
+                    break;
+                }
+
+                std::size_t sequenceLength = validSequenceLength(bytes, special, length);
+                if (sequenceLength == 0) {
+                    output.append("\xEF\xBF\xBD");
+                    replaced++;
+                } else {
+                    output.append(data + special, sequenceLength);
+                    position = special + sequenceLength;
+                }
+                break;
+        }
+    }
+
+    return replaced;
+}
+
+std::size_t XMLEscape::appendEscaped(std::string &output, const std::string &value) {
+    return appendEscaped(output, value.data(), value.length());
+}
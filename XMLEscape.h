@@ -0,0 +1,22 @@
+#ifndef ADRICONF_XMLESCAPE_H
+#define ADRICONF_XMLESCAPE_H
+
+#include <cstddef>
+#include <string>
+
+namespace XMLEscape {
+    /**
+     * Append a value to the output, escaped to be used inside a double-quoted XML attribute
+     * Runs without special characters are found with SSE2/AVX2 (when available) and copied at once.
+     * Invalid UTF-8 sequences are replaced by U+FFFD and control characters not allowed by XML are dropped.
+     * @param output
+     * @param data
+     * @param length
+     * @return The number of invalid sequences or characters replaced or dropped
+     */
+    std::size_t appendEscaped(std::string &output, const char *data, std::size_t length);
+
+    std::size_t appendEscaped(std::string &output, const std::string &value);
+};
+
+#endif
@@ -2,17 +2,45 @@
 #include <gtkmm.h>
 #include <glibmm/i18n.h>
 #include "GUI.h"
+#include "CommandLine.h"
+#include "Counters.h"
+
+namespace {
+    int printStats(int exitCode) {
+        std::cerr << Counters::report();
+        return exitCode;
+    }
+}
 
 int main(int argc, char *argv[]) {
+    Counters::installSignalHandler();
+    bool stats = CommandLine::extractStatsFlag(argc, argv);
+
+    if (CommandLine::isHeadlessCommand(argc, argv)) {
+        int exitCode = CommandLine::run(argc, argv);
+        return stats ? printStats(exitCode) : exitCode;
+    }
+
+    /* GTK would reject an option it doesn't know */
+    unsigned int autosaveDelay;
+    if (!CommandLine::extractAutosaveDelay(argc, argv, autosaveDelay)) {
+        CommandLine::printUsage();
+        return 1;
+    }
+
     /* Start the GUI work */
     auto app = Gtk::Application::create(argc, argv, "br.com.jeanhertel.adriconf");
     try {
-        GUI gui;
+        GUI gui(autosaveDelay);
 
         /* No need to worry about the window pointer as the gui object owns it */
         Gtk::Window *pWindow = gui.getWindowPointer();
 
         app->run(*pWindow);
+
+        if (stats) {
+            std::cerr << gui.describeMemoryUsage();
+        }
     }
     catch (const Glib::FileError &ex) {
         std::cerr << "FileError: " << ex.what() << std::endl;
@@ -27,5 +55,5 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    return 0;
+    return stats ? printStats(0) : 0;
 }
\ No newline at end of file